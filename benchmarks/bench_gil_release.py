@@ -0,0 +1,90 @@
+"""Benchmark of code generation on several threads with the GIL released.
+
+Every job parses the same module into a context of its own and emits an object
+file for it with its own target machine. Reports the wall-clock time of running
+the jobs one after another and on a thread pool, and the resulting speedup,
+which stays around 1x if the GIL is held during code generation.
+
+.. code-block:: bash
+
+   python benchmarks/bench_gil_release.py --jobs 4
+"""
+import argparse
+import json
+import os
+import tempfile
+import time
+from concurrent.futures import ThreadPoolExecutor
+
+from llvmpym import core, target, target_machine
+
+IR = """
+define i64 @work{i}(i64 %n) {{
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi i64 [ 0, %entry ], [ %acc.next, %loop ]
+  %sq = mul i64 %i, %i
+  %acc.next = add i64 %acc, %sq
+  %i.next = add i64 %i, 1
+  %cond = icmp ult i64 %i.next, %n
+  br i1 %cond, label %loop, label %exit
+
+exit:
+  ret i64 %acc.next
+}}
+"""
+
+
+def _compile(ir, path):
+    ctx = core.Context()
+    m = ctx.parse_ir(core.MemoryBuffer.from_str(ir, buffer_name="bench"))
+    triple = target_machine.get_default_target_triple()
+    t = target_machine.Target.get_from_triple(triple)
+    tm = target_machine.TargetMachine(t, triple, target_machine.TargetMachineOptions())
+    tm.emit_to_file(m, path, target_machine.CodeGenFileType.ObjectFile)
+
+
+def run(jobs, functions):
+    target.init_native_target()
+    target.init_native_asm_printer()
+    ir = "\n".join(IR.format(i=i) for i in range(functions))
+
+    with tempfile.TemporaryDirectory() as tmp:
+        paths = [os.path.join(tmp, f"{i}.o") for i in range(jobs)]
+        _compile(ir, paths[0])  # warm up
+
+        start = time.perf_counter()
+        for path in paths:
+            _compile(ir, path)
+        serial = time.perf_counter() - start
+
+        start = time.perf_counter()
+        with ThreadPoolExecutor(max_workers=jobs) as pool:
+            list(pool.map(lambda p: _compile(ir, p), paths))
+        parallel = time.perf_counter() - start
+
+    return {"serial_s": serial, "parallel_s": parallel, "speedup": serial / parallel}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--jobs", type=int, default=os.cpu_count() or 1)
+    parser.add_argument("--functions", type=int, default=200,
+                        help="number of functions in the compiled module")
+    parser.add_argument("--json", help="write the result to this file")
+    args = parser.parse_args()
+
+    result = run(args.jobs, args.functions)
+    for key, value in result.items():
+        print(f"{key}: {value:.3f}")
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(result, f, indent=2)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,85 @@
+"""Contention benchmark of the ownership registry.
+
+Every thread repeatedly creates a context, parses a tiny module into it (which
+also creates and hands over a memory buffer) and drops everything again, so
+each iteration registers and unregisters a context, a memory buffer and a
+module. Reports the total iterations per second for each thread count.
+
+With the GIL, Python-side work is still serialized, so the scaling mostly
+shows on free-threaded Python builds. To compare two revisions, run the script
+on both with ``--json`` and pass the first result to ``--compare``:
+
+.. code-block:: bash
+
+   python benchmarks/bench_ownership.py --json old.json
+   # switch revision, `pip install .`
+   python benchmarks/bench_ownership.py --compare old.json
+"""
+import argparse
+import json
+import threading
+import time
+
+from llvmpym import core
+
+IR = "define i32 @f() {\n  ret i32 0\n}\n"
+
+
+def _worker(iterations, barrier):
+    barrier.wait()
+    for _ in range(iterations):
+        ctx = core.Context()
+        m = ctx.parse_ir(core.MemoryBuffer.from_str(IR, buffer_name="bench"))
+        del m
+        del ctx
+
+
+def _run(threads, iterations):
+    barrier = threading.Barrier(threads + 1)
+    workers = [threading.Thread(target=_worker, args=(iterations, barrier))
+               for _ in range(threads)]
+    for w in workers:
+        w.start()
+    barrier.wait()
+    start = time.perf_counter()
+    for w in workers:
+        w.join()
+    return time.perf_counter() - start
+
+
+def run(thread_counts, iterations, repeat):
+    result = {}
+    for threads in thread_counts:
+        best = min(_run(threads, iterations) for _ in range(repeat))
+        result[f"threads_{threads}_ops_per_s"] = threads * iterations / best
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--threads", type=int, nargs="+", default=[1, 2, 4, 8])
+    parser.add_argument("--iterations", type=int, default=2000,
+                        help="iterations per thread")
+    parser.add_argument("--repeat", type=int, default=3)
+    parser.add_argument("--json", help="write the result to this file")
+    parser.add_argument("--compare", help="result file of a previous run")
+    args = parser.parse_args()
+
+    result = run(args.threads, args.iterations, args.repeat)
+    for key, value in result.items():
+        print(f"{key}: {value:.0f}")
+
+    if args.compare:
+        with open(args.compare) as f:
+            old = json.load(f)
+        for key, value in result.items():
+            if key in old:
+                print(f"{key}: {value / old[key]:.2f}x speedup")
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(result, f, indent=2)
+
+
+if __name__ == "__main__":
+    main()
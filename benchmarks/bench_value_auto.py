@@ -0,0 +1,101 @@
+"""Microbenchmark of wrapping LLVM values into Python objects.
+
+Reports the time per million wraps of
+
+- cold wraps: every visited instruction gets a new wrapper (the previous one is
+  dropped right away), which exercises the subclass dispatch and allocation
+- warm wraps: the wrappers are kept alive, so every visit hits the intern table
+
+To compare two revisions (e.g. before and after a change of the dispatch), run
+the script on both with ``--json`` and pass the first result to ``--compare``:
+
+.. code-block:: bash
+
+   python benchmarks/bench_value_auto.py --json old.json
+   # switch revision, `pip install .`
+   python benchmarks/bench_value_auto.py --compare old.json
+"""
+import argparse
+import json
+import time
+
+from llvmpym import core
+
+# mix of instruction classes so that the dispatch is not trivially predicted
+BODY = """
+  %p{i} = alloca i64
+  store i64 %a, ptr %p{i}
+  %l{i} = load i64, ptr %p{i}
+  %s{i} = add i64 %l{i}, {i}
+  %c{i} = icmp ult i64 %s{i}, %a
+  %g{i} = getelementptr i64, ptr %p{i}, i64 1
+  %x{i} = select i1 %c{i}, i64 %s{i}, i64 %l{i}
+  fence seq_cst
+"""
+
+
+def _make_ir(n):
+    body = "".join(BODY.format(i=i) for i in range(n))
+    return f"define i64 @f(i64 %a) {{\nentry:{body}  ret i64 %a\n}}\n"
+
+
+def _best_of(repeat, fn):
+    best = float("inf")
+    for _ in range(repeat):
+        start = time.perf_counter()
+        fn()
+        best = min(best, time.perf_counter() - start)
+    return best
+
+
+def run(n_blocks, repeat):
+    ctx = core.Context()
+    m = ctx.parse_ir(core.MemoryBuffer.from_str(_make_ir(n_blocks), buffer_name="bench"))
+    block = m.get_named_function("f").entry_basic_block
+    n = sum(1 for _ in block.instructions)
+
+    def cold():
+        for _ in block.instructions:
+            pass
+
+    kept = list(block.instructions)
+
+    def warm():
+        for _ in block.instructions:
+            pass
+
+    result = {
+        "cold_s_per_million": _best_of(repeat, cold) / n * 1e6,
+        "warm_s_per_million": _best_of(repeat, warm) / n * 1e6,
+    }
+    del kept
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--blocks", type=int, default=2000,
+                        help="number of repeated instruction groups")
+    parser.add_argument("--repeat", type=int, default=5)
+    parser.add_argument("--json", help="write the result to this file")
+    parser.add_argument("--compare", help="result file of a previous run")
+    args = parser.parse_args()
+
+    result = run(args.blocks, args.repeat)
+    for key, value in result.items():
+        print(f"{key}: {value:.3f}")
+
+    if args.compare:
+        with open(args.compare) as f:
+            old = json.load(f)
+        for key, value in result.items():
+            if key in old:
+                print(f"{key}: {old[key] / value:.2f}x speedup")
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(result, f, indent=2)
+
+
+if __name__ == "__main__":
+    main()
@@ -13,7 +13,12 @@ void populateBitReader(nb::module_ &m) {
   m.def("parse_bit_code",
         [](PymMemoryBuffer &memBuf) {
           LLVMModuleRef module;
-          auto res = LLVMParseBitcode2(memBuf.get(), &module) == 0;
+          bool res;
+          {
+            PymContextUse use(LLVMGetGlobalContext());
+            nb::gil_scoped_release release;
+            res = LLVMParseBitcode2(memBuf.get(), &module) == 0;
+          }
           if (!res) {
             throw std::runtime_error("Error!");
           }
@@ -27,13 +32,24 @@ void populateBitReader(nb::module_ &m) {
   // LLVMGetBitcodeModule is deprecated in favor of LLVMGetBitcodeModule2
   m.def("get_bitcode_module",
         [](PymMemoryBuffer &memBuf) {
+          memBuf.ensureTransferable();
           LLVMModuleRef module;
-          auto res = LLVMGetBitcodeModule2(memBuf.get(), &module) == 0;
+          bool res;
+          {
+            PymContextUse use(LLVMGetGlobalContext());
+            nb::gil_scoped_release release;
+            res = LLVMGetBitcodeModule2(memBuf.get(), &module) == 0;
+          }
           if (!res) {
             throw std::runtime_error("Error!");
           }
-          // TODO check memBuf availability
+          memBuf.reset(); // owned by the module now
           return PymModule(module);
         },
-        "mem_buf"_a);
+        "mem_buf"_a,
+        "Reads a module from the given memory buffer, lazily: function bodies "
+        "are only loaded when materialized (see Function.materialize and "
+        "Module.materialize_all).\n"
+        "Takes ownership of mem_buf if (and only if) the module was read "
+        "successfully, so it cannot be used afterwards.");
 }
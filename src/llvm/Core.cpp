@@ -6,15 +6,19 @@
 #include "Core/value.h"
 #include "Core/miscClasses.h"
 #include "Core/iterator.h"
+#include "Core/sequence.h"
+#include "Core/export.h"
 
 
 void populateCore(nanobind::module_ &m) {
   bindEnums(m);
   bindGlobalFunctions(m);
   bindTypeClasses(m);
+  bindValueTable(m);
   bindValueClasses(m);
   bindOtherClasses(m);
   bindIterators(m);
+  bindSequences(m);
 }
 
 
@@ -0,0 +1,744 @@
+#include "export.h"
+#include "utils.h"
+
+#include <nanobind/ndarray.h>
+#include <nanobind/stl/string.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/Analysis/CallGraph.h>
+#include <llvm/Analysis/LoopInfo.h>
+#include <llvm/Analysis/PostDominators.h>
+#include <llvm/IR/CFG.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Dominators.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/User.h>
+#include <llvm/IR/Instruction.h>
+#include <llvm/IR/DebugLoc.h>
+#include <llvm/Support/raw_ostream.h>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace nb = nanobind;
+using namespace nb::literals;
+using namespace llvm;
+
+
+namespace {
+
+template <typename T>
+using NumPyArray = nb::ndarray<nb::numpy, T, nb::ndim<1>>;
+
+/*
+ * Hand the contents of `vec` over to a NumPy array without copying
+ */
+template <typename T>
+nb::object toNumPy(std::vector<T> &&vec) {
+  auto *data = new std::vector<T>(std::move(vec));
+  nb::capsule owner(data, [](void *p) noexcept {
+    delete static_cast<std::vector<T>*>(p);
+  });
+  return nb::cast(NumPyArray<T>(data->data(), {data->size()}, owner),
+                  nb::rv_policy::move);
+}
+
+/*
+ * Numbers types in first-seen order
+ */
+class TypeNumbering {
+public:
+  uint32_t getId(Type *T) {
+    auto [it, inserted] = ids.try_emplace(T, types.size());
+    if (inserted)
+      types.push_back(T);
+    return it->second;
+  }
+
+  nb::list getTypeStrs() const {
+    nb::list res;
+    for (auto T : types) {
+      std::string str;
+      raw_string_ostream os(str);
+      T->print(os);
+      res.append(os.str());
+    }
+    return res;
+  }
+
+private:
+  DenseMap<Type*, uint32_t> ids;
+  std::vector<Type*> types;
+};
+
+/*
+ * Edges of a directed graph between value ids
+ */
+struct EdgeList {
+  std::vector<uint32_t> from;
+  std::vector<uint32_t> to;
+
+  void add(uint32_t src, uint32_t dst) {
+    from.push_back(src);
+    to.push_back(dst);
+  }
+};
+
+/*
+ * Counting sort of `edges` by their source into CSR form. The relative order of
+ * the edges of each source node is kept.
+ */
+void buildCSR(size_t numNodes, const std::vector<uint32_t> &from,
+              const std::vector<uint32_t> &to,
+              std::vector<uint64_t> &offsets, std::vector<uint32_t> &targets) {
+  offsets.assign(numNodes + 1, 0);
+  for (auto src : from)
+    offsets[src + 1]++;
+  for (size_t i = 0; i < numNodes; i++)
+    offsets[i + 1] += offsets[i];
+
+  targets.resize(to.size());
+  std::vector<uint64_t> next(offsets.begin(), offsets.end() - 1);
+  for (size_t i = 0; i < from.size(); i++)
+    targets[next[from[i]]++] = to[i];
+}
+
+/*
+ * Tarjan's algorithm over the graph in CSR form, visiting the nodes in `roots`
+ * order (and then all the others) with a single visited set, so every edge is
+ * followed once. Components are appended in bottom-up order (successors first),
+ * like scc_iterator produces them. A component has a cycle if it has more than
+ * one node or its node has an edge to itself.
+ */
+void buildSCCs(size_t numNodes, const std::vector<uint64_t> &offsets,
+               const std::vector<uint32_t> &targets,
+               const std::vector<uint32_t> &roots,
+               std::vector<uint64_t> &sccOffsets, std::vector<uint32_t> &sccNodes,
+               std::vector<uint8_t> &sccHasCycle) {
+  constexpr uint32_t unvisited = UINT32_MAX;
+  std::vector<uint32_t> dfsIndex(numNodes, unvisited), lowLink(numNodes);
+  std::vector<bool> onStack(numNodes, false);
+  std::vector<uint32_t> stack;
+  // node and position of its next successor in `targets`
+  std::vector<std::pair<uint32_t, uint64_t>> dfs;
+  uint32_t nextIndex = 0;
+
+  auto enter = [&](uint32_t node) {
+    dfsIndex[node] = lowLink[node] = nextIndex++;
+    stack.push_back(node);
+    onStack[node] = true;
+    dfs.emplace_back(node, offsets[node]);
+  };
+
+  auto visit = [&](uint32_t root) {
+    if (dfsIndex[root] != unvisited)
+      return;
+    enter(root);
+    while (!dfs.empty()) {
+      auto [node, pos] = dfs.back();
+      if (pos < offsets[node + 1]) {
+        dfs.back().second++;
+        auto succ = targets[pos];
+        if (dfsIndex[succ] == unvisited)
+          enter(succ);
+        else if (onStack[succ])
+          lowLink[node] = std::min(lowLink[node], dfsIndex[succ]);
+        continue;
+      }
+
+      dfs.pop_back();
+      if (!dfs.empty()) {
+        auto parent = dfs.back().first;
+        lowLink[parent] = std::min(lowLink[parent], lowLink[node]);
+      }
+      if (lowLink[node] != dfsIndex[node])
+        continue;
+
+      auto begin = sccNodes.size();
+      uint32_t member;
+      do {
+        member = stack.back();
+        stack.pop_back();
+        onStack[member] = false;
+        sccNodes.push_back(member);
+      } while (member != node);
+      bool hasCycle = sccNodes.size() - begin > 1 ||
+                      std::find(targets.begin() + offsets[node],
+                                targets.begin() + offsets[node + 1],
+                                node) != targets.begin() + offsets[node + 1];
+      sccOffsets.push_back(sccNodes.size());
+      sccHasCycle.push_back(hasCycle);
+    }
+  };
+
+  for (auto root : roots)
+    visit(root);
+  for (uint32_t node = 0; node < numNodes; node++)
+    visit(node);
+}
+
+using ConstantSet = DenseSet<const Constant*>;
+
+/*
+ * Add the edge from `user` to its operand `V`. If `V` is a constant with
+ * operands (a constant expression, an aggregate, ...), also add the edges from
+ * it to its own operands, recursively, unless it is already in `expanded`.
+ * Global values are leaves: the uses by their initializers, aliasees and
+ * resolvers are added by the module export.
+ */
+void addUseEdge(ValueNumbering &values, uint32_t user, const Value *V,
+                ConstantSet &expanded, EdgeList &uses) {
+  SmallVector<std::pair<uint32_t, const Value*>, 8> worklist{{user, V}};
+  while (!worklist.empty()) {
+    auto [from, to] = worklist.pop_back_val();
+    auto id = values.getId(to);
+    uses.add(from, id);
+    auto *C = dyn_cast<Constant>(to);
+    if (!C || isa<GlobalValue>(C) || C->getNumOperands() == 0 ||
+        !expanded.insert(C).second)
+      continue;
+    for (const auto &Op : C->operands())
+      worklist.emplace_back(id, Op.get());
+  }
+}
+
+void addUseEdges(ValueNumbering &values, const Function &F,
+                 ConstantSet &expanded, EdgeList &uses) {
+  for (const auto &BB : F)
+    for (const auto &I : BB) {
+      auto user = values.getId(&I);
+      for (const auto &Op : I.operands())
+        addUseEdge(values, user, Op.get(), expanded, uses);
+    }
+}
+
+nb::dict defUseGraphToDict(ValueNumbering &values, const EdgeList &uses) {
+  std::vector<uint64_t> defUseOffsets, useDefOffsets;
+  std::vector<uint32_t> defUseTargets, useDefTargets;
+  std::vector<int32_t> valueKinds;
+  {
+    nb::gil_scoped_release release;
+    buildCSR(values.size(), uses.from, uses.to, useDefOffsets, useDefTargets);
+    buildCSR(values.size(), uses.to, uses.from, defUseOffsets, defUseTargets);
+    valueKinds = values.getValueKinds();
+  }
+
+  nb::dict res;
+  res["def_use_offsets"] = toNumPy(std::move(defUseOffsets));
+  res["def_use_targets"] = toNumPy(std::move(defUseTargets));
+  res["use_def_offsets"] = toNumPy(std::move(useDefOffsets));
+  res["use_def_targets"] = toNumPy(std::move(useDefTargets));
+  res["value_kind"] = toNumPy(std::move(valueKinds));
+  return res;
+}
+
+using BlockNumbering = DenseMap<const BasicBlock*, uint32_t>;
+
+BlockNumbering numberBlocks(const Function &F) {
+  BlockNumbering numbers;
+  uint32_t index = 0;
+  for (const auto &BB : F)
+    numbers[&BB] = index++;
+  return numbers;
+}
+
+Function &getFunctionWithBody(LLVMValueRef fn) {
+  Function &F = *unwrap<Function>(fn);
+  if (F.isDeclaration())
+    throw nb::value_error("The function has no body.");
+  return F;
+}
+
+}
+
+
+void ValueNumbering::addFunction(const Function &F) {
+  for (const auto &BB : F)
+    for (const auto &I : BB)
+      getId(&I);
+  for (const auto &Arg : F.args())
+    getId(&Arg);
+}
+
+void ValueNumbering::addModule(const Module &M) {
+  for (const auto &F : M.functions())
+    getId(&F);
+  for (const auto &GV : M.globals())
+    getId(&GV);
+  for (const auto &GA : M.aliases())
+    getId(&GA);
+  for (const auto &GI : M.ifuncs())
+    getId(&GI);
+  for (const auto &F : M.functions())
+    addFunction(F);
+}
+
+uint32_t ValueNumbering::getId(const Value *V) {
+  auto [it, inserted] = ids.try_emplace(V, values.size());
+  if (inserted)
+    values.push_back(V);
+  return it->second;
+}
+
+std::vector<int32_t> ValueNumbering::getValueKinds() const {
+  std::vector<int32_t> kinds;
+  kinds.reserve(values.size());
+  for (auto V : values)
+    kinds.push_back(LLVMGetValueKind(wrap(V)));
+  return kinds;
+}
+
+
+PymValueTable::PymValueTable(ValueNumbering values, LLVMContextRef context)
+: values(std::move(values)), context(context),
+  epoch(PymIREpoch::get(context)) { }
+
+ValueNumbering &PymValueTable::getNumbering() {
+  return values;
+}
+
+LLVMContextRef PymValueTable::getContext() const {
+  return context;
+}
+
+void PymValueTable::ensureValid() const {
+  if (PymIREpoch::get(context) != epoch)
+    throw std::runtime_error("The IR may have been modified since the value table "
+                             "was built.");
+}
+
+
+nb::dict exportInstructions(LLVMValueRef fn) {
+  const Function &F = *unwrap<Function>(fn);
+
+  ValueNumbering values;
+  TypeNumbering types;
+  std::vector<uint32_t> opcodes, blocks, typeIds, numOperands, debugLines;
+  std::vector<uint64_t> operandOffsets{0};
+  std::vector<uint32_t> operandIds;
+  uint32_t numInstructions;
+
+  {
+    PymContextUse use(LLVMGetTypeContext(LLVMTypeOf(fn)));
+    nb::gil_scoped_release release;
+    values.addFunction(F);
+    numInstructions = F.getInstructionCount();
+    opcodes.reserve(numInstructions);
+    blocks.reserve(numInstructions);
+    typeIds.reserve(numInstructions);
+    numOperands.reserve(numInstructions);
+    debugLines.reserve(numInstructions);
+    operandOffsets.reserve(numInstructions + 1);
+
+    uint32_t blockIndex = 0;
+    for (const auto &BB : F) {
+      for (const auto &I : BB) {
+        opcodes.push_back(LLVMGetInstructionOpcode(wrap(&I)));
+        blocks.push_back(blockIndex);
+        typeIds.push_back(types.getId(I.getType()));
+        numOperands.push_back(I.getNumOperands());
+        for (const auto &Op : I.operands())
+          operandIds.push_back(values.getId(Op.get()));
+        operandOffsets.push_back(operandIds.size());
+        const DebugLoc &DL = I.getDebugLoc();
+        debugLines.push_back(DL ? DL.getLine() : 0);
+      }
+      blockIndex++;
+    }
+  }
+
+  nb::dict res;
+  res["opcode"] = toNumPy(std::move(opcodes));
+  res["block"] = toNumPy(std::move(blocks));
+  res["type"] = toNumPy(std::move(typeIds));
+  res["num_operands"] = toNumPy(std::move(numOperands));
+  res["operand_offsets"] = toNumPy(std::move(operandOffsets));
+  res["operand_ids"] = toNumPy(std::move(operandIds));
+  res["debug_line"] = toNumPy(std::move(debugLines));
+  res["value_kind"] = toNumPy(values.getValueKinds());
+  res["types"] = types.getTypeStrs();
+  res["num_instructions"] = numInstructions;
+  res["num_arguments"] = F.arg_size();
+  res["value_table"] = nb::cast(PymValueTable(std::move(values),
+                                               LLVMGetTypeContext(LLVMTypeOf(fn))));
+  return res;
+}
+
+
+nb::dict exportDefUseGraph(LLVMValueRef fn) {
+  const Function &F = *unwrap<Function>(fn);
+  ValueNumbering values;
+  EdgeList uses;
+  {
+    PymContextUse use(LLVMGetTypeContext(LLVMTypeOf(fn)));
+    nb::gil_scoped_release release;
+    ConstantSet expanded;
+    values.addFunction(F);
+    addUseEdges(values, F, expanded, uses);
+  }
+
+  auto res = defUseGraphToDict(values, uses);
+  res["num_instructions"] = F.getInstructionCount();
+  res["num_arguments"] = F.arg_size();
+  res["value_table"] = nb::cast(PymValueTable(std::move(values),
+                                               LLVMGetTypeContext(LLVMTypeOf(fn))));
+  return res;
+}
+
+nb::dict exportDefUseGraph(LLVMModuleRef m) {
+  const Module &M = *unwrap(m);
+  ValueNumbering values;
+  EdgeList uses;
+  std::vector<int32_t> functionIndices;
+  {
+    PymContextUse use(LLVMGetModuleContext(m));
+    nb::gil_scoped_release release;
+    ConstantSet expanded;
+    values.addModule(M);
+    for (const auto &GV : M.globals())
+      if (GV.hasInitializer())
+        addUseEdge(values, values.getId(&GV), GV.getInitializer(), expanded, uses);
+    for (const auto &GA : M.aliases())
+      addUseEdge(values, values.getId(&GA), GA.getAliasee(), expanded, uses);
+    for (const auto &GI : M.ifuncs())
+      addUseEdge(values, values.getId(&GI), GI.getResolver(), expanded, uses);
+    for (const auto &F : M.functions())
+      addUseEdges(values, F, expanded, uses);
+
+    functionIndices.assign(values.size(), -1);
+    int32_t index = 0;
+    for (const auto &F : M.functions()) {
+      for (const auto &BB : F)
+        for (const auto &I : BB)
+          functionIndices[values.getId(&I)] = index;
+      for (const auto &Arg : F.args())
+        functionIndices[values.getId(&Arg)] = index;
+      index++;
+    }
+  }
+
+  auto res = defUseGraphToDict(values, uses);
+  res["function"] = toNumPy(std::move(functionIndices));
+  res["num_global_values"] = M.getFunctionList().size() + M.global_size() +
+                             M.alias_size() + M.ifunc_size();
+  res["value_table"] = nb::cast(PymValueTable(std::move(values),
+                                               LLVMGetModuleContext(m)));
+  return res;
+}
+
+
+nb::dict exportCFG(LLVMValueRef fn) {
+  const Function &F = *unwrap<Function>(fn);
+  EdgeList edges;
+  size_t numBlocks;
+  std::vector<uint64_t> succOffsets, predOffsets;
+  std::vector<uint32_t> succTargets, predTargets;
+  {
+    PymContextUse use(LLVMGetTypeContext(LLVMTypeOf(fn)));
+    nb::gil_scoped_release release;
+    auto numbers = numberBlocks(F);
+    numBlocks = numbers.size();
+    for (const auto &BB : F)
+      for (const auto *Succ : successors(&BB))
+        edges.add(numbers[&BB], numbers[Succ]);
+    buildCSR(numBlocks, edges.from, edges.to, succOffsets, succTargets);
+    buildCSR(numBlocks, edges.to, edges.from, predOffsets, predTargets);
+  }
+
+  nb::dict res;
+  res["successor_offsets"] = toNumPy(std::move(succOffsets));
+  res["successor_targets"] = toNumPy(std::move(succTargets));
+  res["predecessor_offsets"] = toNumPy(std::move(predOffsets));
+  res["predecessor_targets"] = toNumPy(std::move(predTargets));
+  res["num_blocks"] = numBlocks;
+  return res;
+}
+
+nb::object exportDominatorTree(LLVMValueRef fn, bool post) {
+  Function &F = getFunctionWithBody(fn);
+  std::vector<int32_t> idoms;
+  {
+    PymContextUse use(LLVMGetTypeContext(LLVMTypeOf(fn)));
+    nb::gil_scoped_release release;
+    auto numbers = numberBlocks(F);
+    idoms.assign(numbers.size(), -1);
+
+    auto fill = [&](auto &tree) {
+      for (const auto &BB : F) {
+        auto *node = tree.getNode(&BB);
+        if (!node || !node->getIDom() || !node->getIDom()->getBlock())
+          continue;
+        idoms[numbers[&BB]] = numbers[node->getIDom()->getBlock()];
+      }
+    };
+
+    if (post) {
+      PostDominatorTree PDT(F);
+      fill(PDT);
+    } else {
+      DominatorTree DT(F);
+      fill(DT);
+    }
+  }
+  return toNumPy(std::move(idoms));
+}
+
+nb::dict exportLoopInfo(LLVMValueRef fn) {
+  Function &F = getFunctionWithBody(fn);
+  std::vector<uint32_t> headers, depths;
+  std::vector<int32_t> parents, blockLoops;
+  std::vector<uint64_t> blockOffsets{0};
+  std::vector<uint32_t> blocks;
+  {
+    PymContextUse use(LLVMGetTypeContext(LLVMTypeOf(fn)));
+    nb::gil_scoped_release release;
+    auto numbers = numberBlocks(F);
+    DominatorTree DT(F);
+    LoopInfo LI(DT);
+
+    // outer loops come before the loops nested in them
+    auto loops = LI.getLoopsInPreorder();
+    DenseMap<const Loop*, int32_t> loopIndices;
+    for (size_t i = 0; i < loops.size(); i++)
+      loopIndices[loops[i]] = i;
+
+    for (const auto *L : loops) {
+      headers.push_back(numbers[L->getHeader()]);
+      depths.push_back(L->getLoopDepth());
+      parents.push_back(L->getParentLoop() ? loopIndices[L->getParentLoop()] : -1);
+      for (const auto *BB : L->blocks())
+        blocks.push_back(numbers[BB]);
+      blockOffsets.push_back(blocks.size());
+    }
+
+    blockLoops.assign(numbers.size(), -1);
+    for (const auto &BB : F)
+      if (auto *L = LI.getLoopFor(&BB))
+        blockLoops[numbers[&BB]] = loopIndices[L];
+  }
+
+  nb::dict res;
+  res["header"] = toNumPy(std::move(headers));
+  res["depth"] = toNumPy(std::move(depths));
+  res["parent"] = toNumPy(std::move(parents));
+  res["block_offsets"] = toNumPy(std::move(blockOffsets));
+  res["blocks"] = toNumPy(std::move(blocks));
+  res["block_loop"] = toNumPy(std::move(blockLoops));
+  return res;
+}
+
+nb::object exportUserOperandIds(LLVMValueRef v, PymValueTable &table) {
+  const User &U = *unwrap<User>(v);
+  table.ensureValid();
+  auto &values = table.getNumbering();
+  std::vector<uint32_t> res;
+  res.reserve(U.getNumOperands());
+  for (const auto &Op : U.operands())
+    res.push_back(values.getId(Op.get()));
+  return toNumPy(std::move(res));
+}
+
+nb::object exportUserOperandKinds(LLVMValueRef v) {
+  const User &U = *unwrap<User>(v);
+  std::vector<int32_t> res;
+  res.reserve(U.getNumOperands());
+  for (const auto &Op : U.operands())
+    res.push_back(LLVMGetValueKind(wrap(Op.get())));
+  return toNumPy(std::move(res));
+}
+
+nb::object exportMDNodeOperandIds(LLVMValueRef v, PymValueTable &table) {
+  table.ensureValid();
+  unsigned num = LLVMGetMDNodeNumOperands(v);
+  std::vector<LLVMValueRef> ops(num);
+  LLVMGetMDNodeOperands(v, ops.data());
+  auto &values = table.getNumbering();
+  std::vector<uint32_t> res;
+  res.reserve(num);
+  for (auto op : ops)
+    res.push_back(op ? values.getId(unwrap(op)) : missingValueId);
+  return toNumPy(std::move(res));
+}
+
+nb::object exportMDNodeOperandKinds(LLVMValueRef v) {
+  unsigned num = LLVMGetMDNodeNumOperands(v);
+  std::vector<LLVMValueRef> ops(num);
+  LLVMGetMDNodeOperands(v, ops.data());
+  std::vector<int32_t> res;
+  res.reserve(num);
+  for (auto op : ops)
+    res.push_back(op ? static_cast<int32_t>(LLVMGetValueKind(op)) : -1);
+  return toNumPy(std::move(res));
+}
+
+nb::dict exportOperandTable(LLVMModuleRef m) {
+  const Module &M = *unwrap(m);
+  ValueNumbering values;
+  std::vector<uint32_t> instIds, opcodes, operandIds;
+  std::vector<int32_t> functionIndices, operandKinds;
+  std::vector<uint64_t> offsets{0};
+  std::vector<int32_t> valueKinds;
+  {
+    PymContextUse use(LLVMGetModuleContext(m));
+    nb::gil_scoped_release release;
+    values.addModule(M);
+    int32_t index = 0;
+    for (const auto &F : M) {
+      for (const auto &BB : F)
+        for (const auto &I : BB) {
+          instIds.push_back(values.getId(&I));
+          opcodes.push_back(LLVMGetInstructionOpcode(wrap(&I)));
+          functionIndices.push_back(index);
+          for (const auto &Op : I.operands()) {
+            operandIds.push_back(values.getId(Op.get()));
+            operandKinds.push_back(LLVMGetValueKind(wrap(Op.get())));
+          }
+          offsets.push_back(operandIds.size());
+        }
+      index++;
+    }
+    valueKinds = values.getValueKinds();
+  }
+
+  nb::dict res;
+  res["instruction_ids"] = toNumPy(std::move(instIds));
+  res["opcode"] = toNumPy(std::move(opcodes));
+  res["function"] = toNumPy(std::move(functionIndices));
+  res["operand_offsets"] = toNumPy(std::move(offsets));
+  res["operand_ids"] = toNumPy(std::move(operandIds));
+  res["operand_kinds"] = toNumPy(std::move(operandKinds));
+  res["value_kind"] = toNumPy(std::move(valueKinds));
+  res["value_table"] = nb::cast(PymValueTable(std::move(values),
+                                               LLVMGetModuleContext(m)));
+  return res;
+}
+
+nb::dict exportCallGraph(LLVMModuleRef m) {
+  Module &M = *unwrap(m);
+  EdgeList calls;
+  size_t numNodes;
+  uint32_t externalCallingNode, callsExternalNode;
+  std::vector<uint64_t> calleeOffsets, callerOffsets, sccOffsets{0};
+  std::vector<uint32_t> callees, callers, sccNodes;
+  std::vector<uint8_t> sccHasCycle;
+  {
+    PymContextUse use(LLVMGetModuleContext(m));
+    nb::gil_scoped_release release;
+    CallGraph CG(M);
+
+    // functions in module order, followed by the two external nodes
+    DenseMap<const CallGraphNode*, uint32_t> ids;
+    uint32_t index = 0;
+    for (auto &F : M)
+      ids[CG[&F]] = index++;
+    externalCallingNode = index++;
+    callsExternalNode = index++;
+    ids[CG.getExternalCallingNode()] = externalCallingNode;
+    ids[CG.getCallsExternalNode()] = callsExternalNode;
+    numNodes = index;
+
+    // also contains the external calling node
+    for (const auto &[_, node] : CG)
+      for (const auto &record : *node)
+        calls.add(ids[node.get()], ids[record.second]);
+
+    buildCSR(numNodes, calls.from, calls.to, calleeOffsets, callees);
+    buildCSR(numNodes, calls.to, calls.from, callerOffsets, callers);
+
+    // start from the external calling node like scc_iterator on the call
+    // graph; functions unreachable from it (e.g. unused internal functions)
+    // follow in module order
+    buildSCCs(numNodes, calleeOffsets, callees, {externalCallingNode},
+              sccOffsets, sccNodes, sccHasCycle);
+  }
+
+  nb::dict res;
+  res["callee_offsets"] = toNumPy(std::move(calleeOffsets));
+  res["callee_targets"] = toNumPy(std::move(callees));
+  res["caller_offsets"] = toNumPy(std::move(callerOffsets));
+  res["caller_targets"] = toNumPy(std::move(callers));
+  res["scc_offsets"] = toNumPy(std::move(sccOffsets));
+  res["scc_nodes"] = toNumPy(std::move(sccNodes));
+  res["scc_has_cycle"] = toNumPy(std::move(sccHasCycle));
+  res["num_nodes"] = numNodes;
+  res["external_calling_node"] = externalCallingNode;
+  res["calls_external_node"] = callsExternalNode;
+  return res;
+}
+
+
+void bindValueTable(nb::module_ &m) {
+  nb::class_<PymValueTable>
+      (m, "ValueTable",
+       "A numbering of values, as used by the ids of the array exports (e.g. "
+       "`Function.export_instructions`, `Module.def_use_graph`), which return "
+       "the table they used under the ``value_table`` key.\n\n"
+       "The numbering of a function: its instructions in program order, followed "
+       "by its arguments, followed by any other value in first-seen order. The "
+       "numbering of a module: the global values (functions, global variables, "
+       "aliases, ifuncs), followed by the instructions and arguments of each "
+       "function, followed by any other value in first-seen order.\n\n"
+       "The table can only be used until the IR of its context is modified.")
+      .def("__init__",
+           [](PymValueTable *t, PymModule &module) {
+             ValueNumbering values;
+             {
+               PymContextUse use(LLVMGetModuleContext(module.get()));
+               nb::gil_scoped_release release;
+               values.addModule(*unwrap(module.get()));
+             }
+             new (t) PymValueTable(std::move(values),
+                                   LLVMGetModuleContext(module.get()));
+           },
+           "module"_a,
+           "Number the values of module.")
+      .def("__init__",
+           [](PymValueTable *t, PymFunction &fn) {
+             auto ctx = LLVMGetTypeContext(LLVMTypeOf(fn.get()));
+             ValueNumbering values;
+             {
+               PymContextUse use(ctx);
+               nb::gil_scoped_release release;
+               values.addFunction(*unwrap<Function>(fn.get()));
+             }
+             new (t) PymValueTable(std::move(values), ctx);
+           },
+           "function"_a,
+           "Number the values of function.")
+      .def("__len__",
+           [](PymValueTable &self) {
+             return self.getNumbering().size();
+           })
+      .def("__getitem__",
+           [](PymValueTable &self, uint32_t id) {
+             self.ensureValid();
+             if (id >= self.getNumbering().size())
+               throw nb::index_error("value id out of range");
+             return PymValueAuto(wrap(self.getNumbering().getValue(id)));
+           },
+           "id"_a,
+           "The value with the given id.\n\n"
+           "Raises:\n"
+           "\tIndexError\n"
+           "\tRuntimeError: the IR may have been modified since the table was "
+           "built.")
+      .def("id",
+           [](PymValueTable &self, PymValue &value) {
+             self.ensureValid();
+             return self.getNumbering().getId(unwrap(value.get()));
+           },
+           "value"_a,
+           "The id of value. A value which isn't in the table yet is numbered "
+           "next.\n\n"
+           "Raises:\n"
+           "\tRuntimeError: the IR may have been modified since the table was "
+           "built.")
+      .def("value_kinds",
+           [](PymValueTable &self) {
+             return toNumPy(self.getNumbering().getValueKinds());
+           },
+           "The ValueKind value of every value id as a NumPy array. "
+           "Requires numpy.");
+}
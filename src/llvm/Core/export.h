@@ -0,0 +1,149 @@
+#ifndef LLVMPYM_CORE_EXPORT_H
+#define LLVMPYM_CORE_EXPORT_H
+
+#include <nanobind/nanobind.h>
+#include <llvm-c/Core.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/IR/Value.h>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Bulk exports of IR into NumPy arrays, built in C++ without creating a Python
+ * wrapper per value.
+ *
+ * Values are identified by a per-function numbering: instructions come first
+ * in program order, followed by the arguments, followed by any other value
+ * (constants, globals, basic blocks, metadata, ...) in first-seen order.
+ *
+ * The per-module numbering starts with the global values (functions, global
+ * variables, aliases, ifuncs, in this order), followed by the instructions and
+ * arguments of each function, followed by any other value in first-seen order.
+ */
+
+/*
+ * A numbering of values as described above. Exports return it to Python as a
+ * `ValueTable`, so that their ids can be mapped back to values.
+ */
+class ValueNumbering {
+public:
+  void addFunction(const llvm::Function &F);
+  void addModule(const llvm::Module &M);
+
+  /*
+   * The id of `V`, which is numbered next if it wasn't seen before
+   */
+  uint32_t getId(const llvm::Value *V);
+
+  const llvm::Value *getValue(uint32_t id) const {
+    return values[id];
+  }
+
+  size_t size() const {
+    return values.size();
+  }
+
+  std::vector<int32_t> getValueKinds() const;
+
+private:
+  llvm::DenseMap<const llvm::Value*, uint32_t> ids;
+  std::vector<const llvm::Value*> values;
+};
+
+/*
+ * A ValueNumbering exposed as `core.ValueTable`. It refers to values by
+ * pointer, so it refuses to hand them out once the IR of its context may have
+ * been modified (see PymIREpoch).
+ */
+class PymValueTable {
+public:
+  PymValueTable(ValueNumbering values, LLVMContextRef context);
+
+  ValueNumbering &getNumbering();
+  LLVMContextRef getContext() const;
+
+  /*
+   * :raises RuntimeError: if the IR may have been modified since the table was
+   * built
+   */
+  void ensureValid() const;
+
+private:
+  ValueNumbering values;
+  LLVMContextRef context;
+  uint64_t epoch;
+};
+
+/**
+ * Walk all the instructions of function `fn`. Returns a dict of column arrays,
+ * see `Function.export_instructions`.
+ */
+nanobind::dict exportInstructions(LLVMValueRef fn);
+
+/**
+ * Build the def-use and use-def graphs of the values used inside function `fn`
+ * (module `m`), following the operands of constants. Returns a dict of CSR
+ * arrays, see `Function.def_use_graph`.
+ */
+nanobind::dict exportDefUseGraph(LLVMValueRef fn);
+
+nanobind::dict exportDefUseGraph(LLVMModuleRef m);
+
+/*
+ * Control flow analyses of a function. Basic blocks are identified by their
+ * index in the function.
+ */
+
+/**
+ * Successor and predecessor lists in CSR form, see `Function.cfg`
+ */
+nanobind::dict exportCFG(LLVMValueRef fn);
+
+/**
+ * The immediate dominator (post-dominator) of every basic block, -1 for none
+ *
+ * :raises ValueError: if `fn` is a declaration
+ */
+nanobind::object exportDominatorTree(LLVMValueRef fn, bool post);
+
+/**
+ * See `Function.loop_info`
+ *
+ * :raises ValueError: if `fn` is a declaration
+ */
+nanobind::dict exportLoopInfo(LLVMValueRef fn);
+
+/**
+ * The ids of the operands of User (MDNode) `v` in `table`, operands not in
+ * the table yet are numbered next. A missing MDNode operand has id
+ * `missingValueId`.
+ */
+nanobind::object exportUserOperandIds(LLVMValueRef v, PymValueTable &table);
+
+nanobind::object exportMDNodeOperandIds(LLVMValueRef v, PymValueTable &table);
+
+/**
+ * The ValueKind values of the operands of User (MDNode) `v`. A missing MDNode
+ * operand has kind -1.
+ */
+nanobind::object exportUserOperandKinds(LLVMValueRef v);
+
+nanobind::object exportMDNodeOperandKinds(LLVMValueRef v);
+
+constexpr uint32_t missingValueId = UINT32_MAX;
+
+void bindValueTable(nanobind::module_ &m);
+
+/**
+ * The operands of all the instructions of module `m`, see `Module.operand_table`
+ */
+nanobind::dict exportOperandTable(LLVMModuleRef m);
+
+/**
+ * The call graph of module `m` and its strongly connected components in
+ * bottom-up order, see `Module.call_graph`
+ */
+nanobind::dict exportCallGraph(LLVMModuleRef m);
+
+
+#endif
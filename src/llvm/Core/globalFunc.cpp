@@ -1,7 +1,9 @@
 #include "globalFunc.h"
 #include <llvm-c/Core.h>
 #include <llvm-c/Core.h>
+#include <nanobind/stl/optional.h>
 #include "../types_priv.h"
+#include "utils.h"
 
 namespace nb = nanobind;
 using namespace nb::literals;
@@ -29,4 +31,36 @@ void bindGlobalFunctions(nb::module_ &m) {
         []() {
           return LLVMIsMultithreaded() != 0;
         });
+
+  m.def("set_context_thread_check", &PymContextUse::setCheckEnabled,
+        "enabled"_a,
+        "Enable or disable the context thread check, a debug mode in which "
+        "RuntimeError is raised when a Context is used by two threads at the "
+        "same time (e.g. parsing into it on one thread while verifying a module "
+        "of it on another), instead of corrupting it.\n\n"
+        "The check covers the operations releasing the GIL (parsing, verifying, "
+        "running passes, code generation, exports, ...) and the creation of "
+        "Python objects for values, types and basic blocks. It is disabled by "
+        "default, or enabled at import when the environment variable "
+        "LLVMPYM_CHECK_CONTEXT_THREADS is set to a non-zero value.");
+
+  m.def("parse_many", &parseMany,
+        "paths_or_buffers"_a, "max_workers"_a = nb::none(),
+        "Parse many textual IR or bitcode inputs concurrently, each into a new "
+        "Context of its own, using up to max_workers native threads (defaults to "
+        "the number of hardware threads).\n\n"
+        "Args:\n"
+        "\tpaths_or_buffers: file paths (str or os.PathLike), MemoryBuffer objects "
+        "(which are not consumed) or bytes-like objects. The format is detected "
+        "from the contents.\n\n"
+        "Returns:\n"
+        "\tThe modules in the order of the inputs. Each module keeps its context "
+        "alive, which can be obtained through ``Module.context``.\n\n"
+        "Raises:\n"
+        "\tRuntimeError: the error of the first input (in input order) which "
+        "failed to parse; no module is returned then.");
+
+  m.def("get_context_thread_check", &PymContextUse::isCheckEnabled,
+        "Whether the context thread check is enabled, see "
+        "set_context_thread_check.");
 }
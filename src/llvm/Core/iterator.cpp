@@ -7,14 +7,19 @@ using namespace nb::literals;
 
 void bindIterators(nb::module_ &m) {
   BIND_ITERATOR_CLASS(PymUseIterator, "UseIterator")
-  // BIND_ITERATOR_CLASS(PymBasicBlockIterator, "BasicBlockIterator")
+  BIND_ITERATOR_CLASS(PymBasicBlockIterator, "BasicBlockIterator")
+  BIND_ITERATOR_CLASS(PymBasicBlockReverseIterator, "BasicBlockReverseIterator")
   // BIND_ITERATOR_CLASS(PymArgumentIterator, "ArgumentIterator")
   BIND_ITERATOR_CLASS(PymInstructionIterator, "InstructionIterator")
+  BIND_ITERATOR_CLASS(PymInstructionReverseIterator, "InstructionReverseIterator")
   BIND_ITERATOR_CLASS(PymGlobalVariableIterator, "GlobalVariableIterator")
+  BIND_ITERATOR_CLASS(PymGlobalVariableReverseIterator, "GlobalVariableReverseIterator")
   BIND_ITERATOR_CLASS(PymGlobalIFuncIterator, "GlobalIFuncIterator")
   BIND_ITERATOR_CLASS(PymGlobalAliasIterator, "GlobalAliasIterator")
   BIND_ITERATOR_CLASS(PymNamedMDNodeIterator, "NamedMDNodeIterator")
+  BIND_ITERATOR_CLASS(PymNamedMDNodeReverseIterator, "NamedMDNodeReverseIterator")
   BIND_ITERATOR_CLASS(PymFunctionIterator, "FunctionIterator")
+  BIND_ITERATOR_CLASS(PymFunctionReverseIterator, "FunctionReverseIterator")
 }
 
 
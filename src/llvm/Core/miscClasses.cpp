@@ -16,8 +16,13 @@
 #include "../types_priv.h"
 #include "../utils_priv.h"
 #include "utils.h"
+#include "export.h"
+#include "sequence.h"
 #include <llvm/IR/Attributes.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/StructuralHash.h>
 #include <llvm/IR/Value.h>
+#include <llvm/Support/Error.h>
 
 
 namespace nb = nanobind;
@@ -27,6 +32,37 @@ template <typename T>
 using optional = std::optional<T>;
 
 
+static int memoryBufferGetBuffer(PyObject *exporter, Py_buffer *view, int flags) {
+  auto *self = nb::inst_ptr<PymMemoryBuffer>(exporter);
+  // counted before checking consumption, so that ensureTransferable on another
+  // thread sees the export
+  self->exports++;
+  if (self->consumed()) {
+    self->exports--;
+    PyErr_SetString(PyExc_BufferError, "The memory buffer has been consumed.");
+    view->obj = nullptr;
+    return -1;
+  }
+  auto mb = self->get();
+  auto start = const_cast<char *>(LLVMGetBufferStart(mb));
+  if (PyBuffer_FillInfo(view, exporter, start, LLVMGetBufferSize(mb), 1, flags) != 0) {
+    self->exports--;
+    return -1;
+  }
+  return 0;
+}
+
+static void memoryBufferReleaseBuffer(PyObject *exporter, Py_buffer *view) {
+  nb::inst_ptr<PymMemoryBuffer>(exporter)->exports--;
+}
+
+static PyType_Slot memoryBufferSlots[] = {
+  {Py_bf_getbuffer, (void *) memoryBufferGetBuffer},
+  {Py_bf_releasebuffer, (void *) memoryBufferReleaseBuffer},
+  {0, nullptr}
+};
+
+
 void bindOtherClasses(nb::module_ &m) {
   auto ContextClass =
     nb::class_<PymContext, PymLLVMObject<PymContext, LLVMContextRef>>
@@ -102,7 +138,11 @@ void bindOtherClasses(nb::module_ &m) {
       (m, "ModuleProvider", "ModuleProvider");
   auto MemoryBufferClass =
     nb::class_<PymMemoryBuffer, PymLLVMObject<PymMemoryBuffer, LLVMMemoryBufferRef>>
-      (m, "MemoryBuffer", "MemoryBuffer");
+      (m, "MemoryBuffer", "MemoryBuffer\n\n"
+       "Supports the buffer protocol, e.g. ``memoryview(buf)`` gives read-only "
+       "access to the contents without copying. The buffer cannot be consumed "
+       "(e.g. by ``Context.parse_ir``) while such views are alive.",
+       nb::type_slots(memoryBufferSlots));
   
   auto PassManagerBaseClass =
     nb::class_<PymPassManagerBase, PymLLVMObject<PymPassManagerBase, LLVMPassManagerRef>>
@@ -188,6 +228,9 @@ void bindOtherClasses(nb::module_ &m) {
            "suitable for link-time optimization and whole-module transformations.")
       .def("run",
            [](PymPassManager &self, PymModule &module) {
+             PymIREpoch::bump(LLVMGetModuleContext(module.get()));
+             PymContextUse use(LLVMGetModuleContext(module.get()));
+             nb::gil_scoped_release release;
              return LLVMRunPassManager(self.get(), module.get()) != 0;
            },
            "module"_a,
@@ -211,6 +254,9 @@ void bindOtherClasses(nb::module_ &m) {
            "pipeline is suitable for code generation and JIT compilation tasks.")
       .def("initialize",
            [](PymFunctionPassManager &self) {
+             // the module of the pass manager isn't known
+             PymIREpoch::bumpAll();
+             nb::gil_scoped_release release;
              return LLVMInitializeFunctionPassManager(self.get()) != 0;
            },
            "Initializes all of the function passes scheduled in the function pass"
@@ -218,6 +264,9 @@ void bindOtherClasses(nb::module_ &m) {
            "otherwise.")
       .def("run",
            [](PymFunctionPassManager &self, PymFunction f) {
+             PymIREpoch::bump(LLVMGetTypeContext(LLVMTypeOf(f.get())));
+             PymContextUse use(LLVMGetTypeContext(LLVMTypeOf(f.get())));
+             nb::gil_scoped_release release;
              return LLVMRunFunctionPassManager(self.get(), f.get()) != 0;
            },
            "f"_a,
@@ -226,6 +275,9 @@ void bindOtherClasses(nb::module_ &m) {
            "function, false otherwise.")
       .def("finalize",
            [](PymFunctionPassManager &self) {
+             // the module of the pass manager isn't known
+             PymIREpoch::bumpAll();
+             nb::gil_scoped_release release;
              return LLVMFinalizeFunctionPassManager(self.get()) != 0;
            },
            "Finalizes all of the function passes scheduled in the function pass"
@@ -249,36 +301,31 @@ void bindOtherClasses(nb::module_ &m) {
              return "<MemoryBuffer>";
            })
       .def_static("from_file",
-                  [](const char *Path) {
-                    LLVMMemoryBufferRef OutMemBuf;
-                    char *OutMessage;
-                    auto success = LLVMCreateMemoryBufferWithContentsOfFile
-                                     (Path, &OutMemBuf, &OutMessage);
-                    if (!success) {
-                      throw std::runtime_error(OutMessage);
-                    }
-
-                    return PymMemoryBuffer(OutMemBuf);
+                  [](const std::string &path, bool mmap) {
+                    return PymMemoryBuffer(createMemoryBufferFromFile(path, mmap));
                   },
-                  "path"_a,
+                  "path"_a, "mmap"_a = true,
+                  "Read a file into a memory buffer. Unless mmap is false, large "
+                  "files are memory mapped instead of being read.\n\n"
                   ":raises RuntimeError")
       .def_static("from_stdin",
                   []() {
                     LLVMMemoryBufferRef OutMemBuf;
-                    char *OutMessage;
+                    char *OutMessage = nullptr;
                     auto success = LLVMCreateMemoryBufferWithSTDIN
-                                     (&OutMemBuf, &OutMessage);
-                    if (!success) {
-                      throw std::runtime_error(OutMessage);
-                    }
+                                     (&OutMemBuf, &OutMessage) == 0;
+                    THROW_ERORR_DISPOSE_MESSAGE_IF_FALSE(success, OutMessage);
                     return PymMemoryBuffer(OutMemBuf);
                   },
                   ":raises RuntimeError")
+      // NOTE the string is converted into a temporary std::string, so its contents
+      // must always be copied. The copy is null terminated.
       .def_static("from_str",
-                  [](std::string &inputData, bool RequiresNullTerminator, const char *BufferName) {
-                    return PymMemoryBuffer(LLVMCreateMemoryBufferWithMemoryRange
+                  [](const std::string &inputData, bool RequiresNullTerminator,
+                     const char *BufferName) {
+                    return PymMemoryBuffer(LLVMCreateMemoryBufferWithMemoryRangeCopy
                                             (inputData.c_str(), inputData.size(),
-                                             BufferName, RequiresNullTerminator));
+                                             BufferName));
                   },
                   "input_data"_a, "requires_null_terminator"_a, "buffer_name"_a = "")
       .def_static("from_str",
@@ -289,10 +336,36 @@ void bindOtherClasses(nb::module_ &m) {
                     WRAP_OPTIONAL_RETURN(res, PymMemoryBuffer);
                   },
                   "input_data"_a, "buffer_name"_a = "")
+      .def_static("from_buffer",
+                  [](nb::handle obj, const std::string &bufferName,
+                     bool requiresNullTerminator) {
+                    return PymMemoryBuffer(createMemoryBufferFromPyBuffer
+                                            (obj, bufferName, requiresNullTerminator),
+                                           requiresNullTerminator);
+                  },
+                  "obj"_a, "buffer_name"_a = "", "requires_null_terminator"_a = false,
+                  "Create a memory buffer referring to the contents of any object "
+                  "supporting the buffer protocol (e.g. bytes, bytearray, mmap.mmap) "
+                  "without copying. obj is kept alive as long as the memory buffer "
+                  "(or a module lazily loaded from it) is alive.\n\n"
+                  "Parsing textual IR requires a null terminated buffer, so "
+                  "Context.parse_ir copies the contents of a buffer created without "
+                  "requires_null_terminator (bitcode is still parsed in place). To "
+                  "avoid the copy, pass data ending with a null byte and set "
+                  "requires_null_terminator, the null byte is then not part of the "
+                  "buffer contents.\n\n"
+                  "Raises:\n"
+                  "\tValueError: requires_null_terminator is set but obj doesn't end "
+                  "with a null byte.")
       .def_prop_ro("buffer_start",
-                   [](PymMemoryBuffer &self) {
-                     return LLVMGetBufferStart(self.get());
-                   })
+                   [](nb::handle self) {
+                     auto view = PyMemoryView_FromObject(self.ptr());
+                     if (!view)
+                       throw nb::python_error();
+                     return nb::steal(view);
+                   },
+                   "A read-only memoryview of the buffer contents (no copy is "
+                   "made).")
       .def_prop_ro("buffer_size",
                    [](PymMemoryBuffer &self) {
                      return LLVMGetBufferSize(self.get());
@@ -356,6 +429,7 @@ void bindOtherClasses(nb::module_ &m) {
            })
       .def("insert",
            [](PymBuilder &self, PymBasicBlock &bb) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              return LLVMInsertExistingBasicBlockAfterInsertBlock(self.get(), bb.get());
            },
            "basic_block"_a,
@@ -364,11 +438,13 @@ void bindOtherClasses(nb::module_ &m) {
            "The insertion point must be valid.")
       .def("insert",
            [](PymBuilder &self, PymInstruction &inst) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              return LLVMInsertIntoBuilder(self.get(), inst.get());
            },
            "instruction"_a)
       .def("insert_with_name",
            [](PymBuilder &self, PymInstruction &inst, const char *name) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              return LLVMInsertIntoBuilderWithName(self.get(), inst.get(), name);
            },
            "instruction"_a, "name"_a = "")
@@ -400,15 +476,18 @@ void bindOtherClasses(nb::module_ &m) {
         */
       .def("ret_void",
            [](PymBuilder &self) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              return PymReturnInst(LLVMBuildRetVoid(self.get()));
            })
       .def("ret",
            [](PymBuilder &self, PymValue &v) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              return PymReturnInst(LLVMBuildRet(self.get(), v.get()));
            },
            "value"_a)
       .def("aggregate_ret",
            [](PymBuilder &self, std::vector<PymValue> &values) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              unsigned num = values.size();
              UNWRAP_VECTOR_WRAPPER_CLASS(LLVMValueRef, values, raw, num);
              return PymReturnInst(LLVMBuildAggregateRet(self.get(), raw.data(), num));
@@ -416,12 +495,14 @@ void bindOtherClasses(nb::module_ &m) {
            "values"_a)
       .def("br",
            [](PymBuilder &self, PymBasicBlock &dest) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              return PymBranchInst(LLVMBuildBr(self.get(), dest.get()));
            },
            "dest"_a)
       .def("cond_br",
            [](PymBuilder &self, PymValue &If, PymBasicBlock &Then,
               PymBasicBlock &Else) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              return PymBranchInst(LLVMBuildCondBr(self.get(), If.get(),
                                                  Then.get(), Else.get()));
            },
@@ -429,17 +510,20 @@ void bindOtherClasses(nb::module_ &m) {
       .def("switch",
            [](PymBuilder &self, PymValue &value, PymBasicBlock &Else,
               unsigned numCases) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              return PymSwitchInst(LLVMBuildSwitch(self.get(), value.get(), Else.get(), numCases));
            },
            "value"_a, "Else"_a, "num_cases"_a)
       .def("indirect_br",
            [](PymBuilder &self, PymValue &addr, unsigned numDests) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              return PymIndirectBrInst(LLVMBuildIndirectBr(self.get(), addr.get(), numDests));
            },
            "addr"_a, "num_dests"_a)
       .def("invoke",
            [](PymBuilder &self, PymType &type, PymFunction &fn, std::vector<PymValue> args,
               PymBasicBlock Then, PymBasicBlock Catch, const char *name) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              unsigned args_num  = args.size();
              UNWRAP_VECTOR_WRAPPER_CLASS(LLVMValueRef, args, rawArgs, args_num);
              auto res = LLVMBuildInvoke2(self.get(), type.get(), fn.get(),
@@ -453,6 +537,7 @@ void bindOtherClasses(nb::module_ &m) {
            [](PymBuilder &self, PymType &type, PymFunction &fn, std::vector<PymValue> args,
               PymBasicBlock Then, PymBasicBlock Catch,
               std::vector<PymOperandBundle> bundles, const char *name) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              unsigned args_num  = args.size();
              UNWRAP_VECTOR_WRAPPER_CLASS(LLVMValueRef, args, rawArgs, args_num);
 
@@ -471,16 +556,19 @@ void bindOtherClasses(nb::module_ &m) {
            "name"_a = "")
       .def("unreachable",
            [](PymBuilder &self) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              return PymInstruction(LLVMBuildUnreachable(self.get()));
            })
       .def("resume",
            [](PymBuilder &self, PymValue &exn) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              return PymInstruction(LLVMBuildResume(self.get(), exn.get()));
            },
            "exn"_a)
       .def("landing_pad",
            [](PymBuilder &self, PymType &type, PymValue &PersFn, unsigned numClauses,
               const char *name) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              return PymLandingPadInst(LLVMBuildLandingPad
                                        (self.get(), type.get(), PersFn.get(), numClauses,
                                         name));
@@ -488,6 +576,7 @@ void bindOtherClasses(nb::module_ &m) {
            "type"_a, "pers_fn"_a, "num_clauses"_a, "name"_a = "")
       .def("cleanup_ret",
            [](PymBuilder &self, PymValue &catchPad, PymBasicBlock bb) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              return PymCleanupReturnInst(LLVMBuildCleanupRet(self.get(), catchPad.get(),
                                                             bb.get()));
            },
@@ -495,6 +584,7 @@ void bindOtherClasses(nb::module_ &m) {
       .def("catch_pad",
            [](PymBuilder &self, PymValue &parentPad, std::vector<PymValue> args,
               const char *name) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              unsigned args_num  = args.size();
              UNWRAP_VECTOR_WRAPPER_CLASS(LLVMValueRef, args, rawArgs, args_num);
 
@@ -506,6 +596,7 @@ void bindOtherClasses(nb::module_ &m) {
       .def("cleanup_pad",
            [](PymBuilder &self, PymValue &parentPad, std::vector<PymValue> args,
               const char *name) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              unsigned args_num  = args.size();
              UNWRAP_VECTOR_WRAPPER_CLASS(LLVMValueRef, args, rawArgs, args_num);
 
@@ -517,6 +608,7 @@ void bindOtherClasses(nb::module_ &m) {
       .def("catch_switch",
            [](PymBuilder &self, PymValue &parentPad, PymBasicBlock &unwindBB,
               unsigned numHandlers, const char *name) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              auto res = LLVMBuildCatchSwitch(self.get(), parentPad.get(),
                                              unwindBB.get(), numHandlers,
                                              name);
@@ -530,40 +622,49 @@ void bindOtherClasses(nb::module_ &m) {
       .def("binop",
            [](PymBuilder &self, LLVMOpcode op, PymValue &lhs, PymValue &rhs,
               const char *name) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              return PymValueAuto(LLVMBuildBinOp(self.get(), op, lhs.get(), rhs.get(), name));
            })
       .def("neg",
            [](PymBuilder &self, PymValue &v, const char *name) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              return PymValueAuto(LLVMBuildNeg(self.get(), v.get(), name));
            })
       .def("neg_nsw",
            [](PymBuilder &self, PymValue &v, const char *name) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              return PymValueAuto(LLVMBuildNSWNeg(self.get(), v.get(), name));
            })
       .def("neg_nuw",
            [](PymBuilder &self, PymValue &v, const char *name) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              return PymValueAuto(LLVMBuildNUWNeg(self.get(), v.get(), name));
            })
       .def("fneg",
            [](PymBuilder &self, PymValue &v, const char *name) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              return PymValueAuto(LLVMBuildFNeg(self.get(), v.get(), name));
            })
       .def("not_",
            [](PymBuilder &self, PymValue &v, const char *name) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              return PymValueAuto(LLVMBuildNot(self.get(), v.get(), name));
            })
       .def("malloc",
            [](PymBuilder &self, PymType &type, const char *name) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              return PymCallInst(LLVMBuildMalloc(self.get(), type.get(), name));
            },
            "type"_a, "name"_a = "")
       .def("array_malloc",
            [](PymBuilder &self, PymType &type, PymValue &val, const char *name) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              return PymCallInst(LLVMBuildArrayAlloca(self.get(), type.get(), val.get(), name));
            },
            "type"_a, "value"_a, "name"_a = "")
       .def("memset",
            [](PymBuilder &self, PymValue &ptr, PymValue &val, PymValue &len, unsigned align) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              auto res = LLVMBuildMemSet(self.get(), ptr.get(), val.get(), len.get(),
                                         align);
              return PymCallInst(res);
@@ -572,6 +673,7 @@ void bindOtherClasses(nb::module_ &m) {
       .def("memcpy",
            [](PymBuilder &self, PymValue &dest, unsigned dstAlign, PymValue &src,
               unsigned srcAlign, PymValue size) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              auto res = LLVMBuildMemCpy(self.get(), dest.get(), dstAlign, src.get(),
                                         srcAlign, size.get());
              return PymCallInst(res);
@@ -581,6 +683,7 @@ void bindOtherClasses(nb::module_ &m) {
       .def("mem_move",
            [](PymBuilder &self, PymValue &dest, unsigned dstAlign, PymValue &src,
               unsigned srcAlign, PymValue size) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              auto res = LLVMBuildMemMove(self.get(), dest.get(), dstAlign, src.get(),
                                          srcAlign, size.get());
              return PymCallInst(res);
@@ -589,34 +692,40 @@ void bindOtherClasses(nb::module_ &m) {
            "Creates and inserts a memmove between the specified pointers.")
       .def("alloca",
            [](PymBuilder &self, PymType &type, const char *name) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              return PymAllocaInst(LLVMBuildAlloca(self.get(), type.get(), name));
            },
            "type"_a, "name"_a = "")
       .def("array_alloca",
            [](PymBuilder &self, PymType &type, PymValue &val, const char *name) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              return PymAllocaInst(LLVMBuildArrayAlloca(self.get(), type.get(),
                                                       val.get(), name));
            },
            "type"_a, "value"_a, "name"_a = "")
       .def("free",
            [](PymBuilder &self, PymValue pointer) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              return PymCallInst(LLVMBuildFree(self.get(), pointer.get()));
            },
            "pointer"_a)
       .def("load2",
            [](PymBuilder &self, PymType &type, PymValue &pointer, const char *name) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              return PymLoadInst(LLVMBuildLoad2(self.get(), type.get(), pointer.get(),
                                               name));
            },
            "type"_a, "ptr"_a, "name"_a = "")
       .def("store",
            [](PymBuilder &self, PymValue &val, PymValue &ptr) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              return PymStoreInst(LLVMBuildStore(self.get(), val.get(), ptr.get()));
            },
            "value"_a, "ptr"_a)
       .def("gep2",
            [](PymBuilder &self, PymType &type, PymValue &ptr, std::vector<PymValue> indices,
               const char *name) {
+             PymIREpoch::bump(getBuilderContext(self.get()));
              unsigned num_indices = indices.size();
              UNWRAP_VECTOR_WRAPPER_CLASS(LLVMValueRef, indices, rawIndices, num_indices);
              return PymValueAuto(LLVMBuildGEP2(self.get(), type.get(), ptr.get(),
@@ -626,6 +735,7 @@ void bindOtherClasses(nb::module_ &m) {
      .def("in_bounds_gep2",
           [](PymBuilder &self, PymType &type, PymValue &ptr, std::vector<PymValue> indices,
              const char *name) {
+            PymIREpoch::bump(getBuilderContext(self.get()));
             unsigned num_indices = indices.size();
             UNWRAP_VECTOR_WRAPPER_CLASS(LLVMValueRef, indices, rawIndices, num_indices);
             return PymValueAuto(LLVMBuildGEP2(self.get(), type.get(), ptr.get(),
@@ -634,6 +744,7 @@ void bindOtherClasses(nb::module_ &m) {
           "type"_a,  "ptr"_a, "indices"_a, "name"_a = "")
      .def("struct_gep2",
           [](PymBuilder &self, PymType &type, PymValue &ptr, unsigned index, const char *name) {
+            PymIREpoch::bump(getBuilderContext(self.get()));
             auto res = LLVMBuildStructGEP2(self.get(), type.get(), ptr.get(),
                                            index, name);
             return PymValueAuto(res);
@@ -641,10 +752,12 @@ void bindOtherClasses(nb::module_ &m) {
           "type"_a, "ptr"_a, "index"_a, "name"_a = "")
      .def("global_string",
           [](PymBuilder &self, const char *str, const char *name) {
+            PymIREpoch::bump(getBuilderContext(self.get()));
             return PymValueAuto(LLVMBuildGlobalString(self.get(), str, name));
           })
      .def("global_string_ptr",
           [](PymBuilder &self, const char *str, const char *name) {
+            PymIREpoch::bump(getBuilderContext(self.get()));
             return PymValueAuto(LLVMBuildGlobalStringPtr(self.get(), str, name));
           })
        /* cast start  */
@@ -652,18 +765,21 @@ void bindOtherClasses(nb::module_ &m) {
      .def("cast",
           [](PymBuilder &self, LLVMOpcode opcode, PymValue &value,  PymType &destType,
              const char *name) {
+            PymIREpoch::bump(getBuilderContext(self.get()));
             return PymValueAuto(LLVMBuildCast(self.get(), opcode, value.get(),
                                              destType.get(), name));
           },
           "opcode"_a, "value"_a, "dest_type"_a, "name"_a = "")
      .def("int_cast_2",
           [](PymBuilder &self, PymValue &value, PymType &destType, const char *name){
+            PymIREpoch::bump(getBuilderContext(self.get()));
             return PymValueAuto(LLVMBuildFPCast
                                  (self.get(), value.get(), destType.get(), name));
           },
           "value"_a, "dest_type"_a, "name"_a = "")
      .def("int_cast",
           [](PymBuilder &self, PymValue &value, PymType &destType, const char *name){
+            PymIREpoch::bump(getBuilderContext(self.get()));
             return PymValueAuto(LLVMBuildIntCast
                                  (self.get(), value.get(), destType.get(), name));
           },
@@ -679,18 +795,21 @@ void bindOtherClasses(nb::module_ &m) {
      .def("icmp",
           [](PymBuilder &self, LLVMIntPredicate op, PymValue &lhs, PymValue &rhs,
              const char *name) {
+            PymIREpoch::bump(getBuilderContext(self.get()));
             return PymValueAuto(LLVMBuildICmp(self.get(), op, lhs.get(), rhs.get(),
                                              name));
           },
           "op"_a, "lhs"_a, "rhs"_a, "name"_a = "")
      .def("phi",
           [](PymBuilder &self, PymType &type, const char *name) {
+            PymIREpoch::bump(getBuilderContext(self.get()));
             return PymPHINode(LLVMBuildPhi(self.get(), type.get(), name));
           },
           "type"_a, "name"_a = "")
      .def("call_2",
           [](PymBuilder &self, PymTypeFunction &type, PymFunction &fn, std::vector<PymValue> args,
              const char *name) {
+            PymIREpoch::bump(getBuilderContext(self.get()));
             unsigned args_num = args.size();
             UNWRAP_VECTOR_WRAPPER_CLASS(LLVMValueRef, args, rawArgs, args_num);
             return PymCallInst(LLVMBuildCall2
@@ -703,6 +822,7 @@ void bindOtherClasses(nb::module_ &m) {
              std::vector<PymValue> args,
              std::vector<PymOperandBundle> bundles,
              const char *name) {
+            PymIREpoch::bump(getBuilderContext(self.get()));
             unsigned args_num = args.size();
             UNWRAP_VECTOR_WRAPPER_CLASS(LLVMValueRef, args, rawArgs, args_num);
 
@@ -717,6 +837,7 @@ void bindOtherClasses(nb::module_ &m) {
      .def("select",
           [](PymBuilder &self, PymValue &If, PymValue &Then, PymValue &Else,
              const char *name) {
+            PymIREpoch::bump(getBuilderContext(self.get()));
             return PymCallInst(LLVMBuildSelect
                                 (self.get(), If.get(), Then.get(), Else.get(),
                                  name));
@@ -724,12 +845,14 @@ void bindOtherClasses(nb::module_ &m) {
           "If"_a, "Then"_a, "Else"_a, "name"_a = "")
      .def("vaarg",
           [](PymBuilder &self, PymValue &list, PymType &type, const char *name) {
+            PymIREpoch::bump(getBuilderContext(self.get()));
             return PymValue(LLVMBuildVAArg(self.get(), list.get(), type.get(),
                                           name));
           },
           "list"_a, "type"_a, "name"_a = "")
      .def("extract_element",
           [](PymBuilder &self, PymValue &vecVal, PymValue &index, const char *name) {
+            PymIREpoch::bump(getBuilderContext(self.get()));
             return PymValueAuto(LLVMBuildExtractElement
                                  (self.get(), vecVal.get(), index.get(), name));
           },
@@ -737,6 +860,7 @@ void bindOtherClasses(nb::module_ &m) {
      .def("insert_element",
           [](PymBuilder &self, PymValue &vecVal, PymValue &eltVal,
              PymValue &index, const char *name) {
+            PymIREpoch::bump(getBuilderContext(self.get()));
             return PymValueAuto(LLVMBuildInsertElement
                                  (self.get(), vecVal.get(), eltVal.get(),
                                   index.get(), name));
@@ -744,12 +868,14 @@ void bindOtherClasses(nb::module_ &m) {
           "vec"_a, "element"_a, "index"_a, "name"_a = "")
     .def("shuffle_vector",
          [](PymBuilder &self, PymValue &v1, PymValue &v2, PymValue &mask, const char *name) {
+           PymIREpoch::bump(getBuilderContext(self.get()));
            return PymShuffleVectorInst(LLVMBuildShuffleVector
                                         (self.get(), v1.get(), v2.get(), mask.get(), name));
          },
          "v1"_a, "v2"_a, "mask"_a, "name"_a = "")
     .def("extract_value",
          [](PymBuilder &self, PymValue &aggVal, unsigned index, const char *name) {
+           PymIREpoch::bump(getBuilderContext(self.get()));
            return PymValueAuto(LLVMBuildExtractValue
                                 (self.get(), aggVal.get(), index, name));
          },
@@ -757,6 +883,7 @@ void bindOtherClasses(nb::module_ &m) {
     .def("insert_value",
          [](PymBuilder &self, PymValue &aggVal, PymValue &eltVal, unsigned index,
             const char *name) {
+           PymIREpoch::bump(getBuilderContext(self.get()));
            return PymValueAuto(LLVMBuildInsertValue
                                 (self.get(), aggVal.get(), eltVal.get(), index,
                                  name));
@@ -764,22 +891,26 @@ void bindOtherClasses(nb::module_ &m) {
          "agg"_a, "elt"_a, "index"_a, "name"_a = "")
     .def("freeze",
          [](PymBuilder &self, PymValue &val, const char *name) {
+           PymIREpoch::bump(getBuilderContext(self.get()));
            return PymValueAuto(LLVMBuildFreeze(self.get(), val.get(), name));
          },
          "val"_a, "name"_a = "")
     .def("is_null",
          [](PymBuilder &self, PymValue &val, const char *name) {
+           PymIREpoch::bump(getBuilderContext(self.get()));
            return PymValueAuto(LLVMBuildIsNull(self.get(), val.get(), name));
          },
          "value"_a, "name"_a = "")
     .def("is_not_null",
          [](PymBuilder &self, PymValue &val, const char *name) {
+           PymIREpoch::bump(getBuilderContext(self.get()));
            return PymValueAuto(LLVMBuildIsNotNull(self.get(), val.get(), name));
          },
          "value"_a, "name"_a = "")
     .def("ptr_diff_2",
          [](PymBuilder &self, PymType &elemType, PymValue &lhs, PymValue &rhs,
             const char *name) {
+           PymIREpoch::bump(getBuilderContext(self.get()));
            return PymValueAuto(LLVMBuildPtrDiff2
                                 (self.get(), elemType.get(), lhs.get(),
                                  rhs.get(), name));
@@ -788,12 +919,14 @@ void bindOtherClasses(nb::module_ &m) {
     .def("fence",
          [](PymBuilder &self, LLVMAtomicOrdering ordering, bool singleThread,
             const char *name) {
+           PymIREpoch::bump(getBuilderContext(self.get()));
            return PymFenceInst(LLVMBuildFence(self.get(), ordering, singleThread, name));
          },
          "ordering"_a, "singleThread"_a, "name"_a = "")
     .def("atomic_rmw",
          [](PymBuilder &self, LLVMAtomicRMWBinOp op, PymValue &ptr, PymValue val,
             LLVMAtomicOrdering ordering, bool singleThread) {
+           PymIREpoch::bump(getBuilderContext(self.get()));
            auto res = LLVMBuildAtomicRMW(self.get(), op, ptr.get(), val.get(), ordering,
                                          singleThread);
            return PymAtomicRMWInst(res);
@@ -803,6 +936,7 @@ void bindOtherClasses(nb::module_ &m) {
          [](PymBuilder &self, PymValue &ptr, PymValue &cmp, PymValue &New,
             LLVMAtomicOrdering successOrdering, LLVMAtomicOrdering failureOrdering,
             bool singleThread) {
+           PymIREpoch::bump(getBuilderContext(self.get()));
            auto res = LLVMBuildAtomicCmpXchg(self.get(), ptr.get(), cmp.get(),
                                              New.get(), successOrdering,
                                              failureOrdering, singleThread);
@@ -829,6 +963,7 @@ void bindOtherClasses(nb::module_ &m) {
            "Create a new basic block without inserting it into a function.")
       .def("__init__",
            [](PymBasicBlock *bb, PymContext &c, PymFunction &f, const char *name) {
+             PymIREpoch::bump(c.get());
              new (bb) PymBasicBlock(LLVMAppendBasicBlockInContext
                                      (c.get(), f.get(), name));
            },
@@ -836,6 +971,7 @@ void bindOtherClasses(nb::module_ &m) {
            "Create a new basic block without inserting it into a function.")
       .def("__init__",
            [](PymBasicBlock *bb, PymContext &c, PymBasicBlock &BB, const char *name) {
+             PymIREpoch::bump(c.get());
              new (bb) PymBasicBlock(LLVMInsertBasicBlockInContext
                                      (c.get(), BB.get(), name));
            },
@@ -845,6 +981,7 @@ void bindOtherClasses(nb::module_ &m) {
            "passed basic block.")
       .def("__init__",
            [](PymBasicBlock *bb, PymBasicBlock &BB, const char *name) {
+             PymIREpoch::bump(getBasicBlockContext(BB.get()));
              new (bb) PymBasicBlock(LLVMInsertBasicBlock(BB.get(), name));
            },
            "insert_before_bb"_a, "name"_a = "",
@@ -892,16 +1029,20 @@ void bindOtherClasses(nb::module_ &m) {
                    })
       .def_prop_ro("instructions",
                    [](PymBasicBlock &self) {
-                     auto res = LLVMGetFirstInstruction(self.get());
-                     return PymInstructionIterator(PymInstruction(res));
-                   })
+                     return PymInstructionSequence(self.get());
+                   },
+                   "The instructions in the basic block, as a sequence supporting "
+                   "len, indexing and reversed.")
       .def("create_and_insert_before",
            [](PymBasicBlock &self, const char *name) {
+             PymIREpoch::bump(getBasicBlockContext(self.get()));
              return PymBasicBlock(LLVMInsertBasicBlock(self.get(), name));
            },
            "Insert a basic block in a function using the global context.")
       .def("destroy", // TODO test
            [](PymBasicBlock &self) {
+             PymIREpoch::bump(getBasicBlockContext(self.get()));
+             forgetInternedBasicBlock(self.get());
              return LLVMDeleteBasicBlock(self.get());
            },
            "Remove a basic block from a function and delete it.\n\n"
@@ -909,6 +1050,7 @@ void bindOtherClasses(nb::module_ &m) {
            "the basic block itself.")
       .def("remove_from_parent",
            [](PymBasicBlock &self) {
+             PymIREpoch::bump(getBasicBlockContext(self.get()));
              return LLVMRemoveBasicBlockFromParent(self.get());
            },
            "Remove a basic block from a function.\n\n"
@@ -916,12 +1058,14 @@ void bindOtherClasses(nb::module_ &m) {
            "the basic block alive.")
       .def("move_before",
            [](PymBasicBlock &self, PymBasicBlock posBB) {
+             PymIREpoch::bump(getBasicBlockContext(self.get()));
              return LLVMMoveBasicBlockBefore(self.get(), posBB.get());
            },
            "pos"_a,
            "Move a basic block to before another one.")
       .def("move_after",
            [](PymBasicBlock &self, PymBasicBlock posBB) {
+             PymIREpoch::bump(getBasicBlockContext(self.get()));
              return LLVMMoveBasicBlockAfter(self.get(), posBB.get());
            },
            "pos",
@@ -1252,10 +1396,10 @@ void bindOtherClasses(nb::module_ &m) {
                   "Obtain the global context instance.")
       .def_prop_ro("diagnostic_context",
                    [](PymContext &c) {
-                     // FIXME the returned value is nb::capsule, which is meaningless
-                     return LLVMContextGetDiagnosticContext(c.get());
+                     return getDiagnosticContext(c.get());
                    },
-                   "Get the diagnostic context of this context.")
+                   "Get the diagnostic context given to set_diagnostic_handler, "
+                   "or None.")
       .def_prop_rw("should_discard_value_names", // TODO convert LLVMBool to bool
                    [](PymContext &c) -> bool {
                      return LLVMContextShouldDiscardValueNames(c.get()) != 0;
@@ -1276,33 +1420,22 @@ void bindOtherClasses(nb::module_ &m) {
                       "This can be used to save memory and runtime, "
                       "especially in release mode."))
       .def("set_diagnostic_handler",
-           [](PymContext &c,
-              // NOTE how to use `nb::any` here?
-              std::function<void(PymDiagnosticInfo, nb::object)> handler,
-              nb::any diagnosticContext){
-             static std::function<void(PymDiagnosticInfo, nb::object)> *callback =
-               new std::function<void(PymDiagnosticInfo, nb::object)>(std::move(handler));
-             return LLVMContextSetDiagnosticHandler
-                      (c.get(),
-                       [](LLVMDiagnosticInfoRef di, void * v) {
-                         if (callback) {
-                           (*callback)(PymDiagnosticInfo(di), nb::capsule(v));
-                         }
-                       },
-                       &diagnosticContext);
-           },
-           "handler"_a, "diagnostic_context"_a,
-           "Set the diagnostic handler for this context.")
+           [](PymContext &c, nb::callable handler, nb::object diagnosticContext) {
+             setDiagnosticHandler(c.get(), std::move(handler),
+                                  std::move(diagnosticContext));
+           },
+           "handler"_a, "diagnostic_context"_a = nb::none(),
+           "Set the diagnostic handler for this context.\n\n"
+           "handler is called as ``handler(diagnostic_info, diagnostic_context)``. "
+           "Every context has its own handler, which is kept until it is replaced "
+           "or the context is disposed. Exceptions raised by the handler are "
+           "reported as unraisable exceptions, since they cannot propagate "
+           "through LLVM.")
       .def("get_diagnostic_handler",
-           [](PymContext &c)  {
-             auto funcPtr = LLVMContextGetDiagnosticHandler(c.get());
-             std::function<void(PymDiagnosticInfo, nb::object)> fn =
-               [funcPtr](PymDiagnosticInfo di, nb::object obj) {
-                 funcPtr(di.get(), &obj);
-               };
-             return fn;
-           },
-           "Get the diagnostic handler of this context.")
+           [](PymContext &c) {
+             return getDiagnosticHandler(c.get());
+           },
+           "Get the diagnostic handler given to set_diagnostic_handler, or None.")
       // .def("set_yield_callback", // FIXME cannot compile on WINDOWS build
       //      [](PymContext &c, LLVMYieldCallback callback, void *opaqueHandle){
       //        return LLVMContextSetYieldCallback(c.get(), callback, opaqueHandle);
@@ -1311,7 +1444,8 @@ void bindOtherClasses(nb::module_ &m) {
       //      "Set the yield callback function for this context.")
       .def("parse_ir",
            [](PymContext &self, PymMemoryBuffer &memBuf) {
-             auto res = parseIR(self.get(), memBuf.get());
+             memBuf.ensureTransferable();
+             auto res = parseIR(self.get(), memBuf.get(), memBuf.nullTerminated());
              memBuf.reset(); // We Cannot reuse the memory buffer again
              return res;
            },
@@ -1320,6 +1454,25 @@ void bindOtherClasses(nb::module_ &m) {
            "object.\n\n"
            ":raises RuntimeError\n"
            "NOTE that you cannot use passed-in memory_buffer after this operation.")
+      .def("parse_ir_file",
+           [](PymContext &self, const std::string &path) {
+             return parseIR(self.get(), createMemoryBufferFromFile(path, true));
+           },
+           "path"_a,
+           "Read LLVM IR (textual or bitcode) from a file and convert it into an "
+           "in-memory Module object. The file is memory mapped when worthwhile and "
+           "never passes through Python.\n\n"
+           ":raises RuntimeError")
+      .def("parse_bitcode_file",
+           [](PymContext &self, const std::string &path, bool lazy) {
+             return parseBitcodeFile(self.get(), path, lazy);
+           },
+           "path"_a, "lazy"_a = false,
+           "Build a module from the bitcode file. The file is memory mapped when "
+           "worthwhile and never passes through Python.\n\n"
+           "If lazy is true, function bodies are only loaded when materialized "
+           "(see Function.materialize and Module.materialize_all).\n\n"
+           ":raises RuntimeError")
       .def("create_builder",
            [](PymContext &self) {
              return PymBuilder(LLVMCreateBuilderInContext(self.get()));
@@ -1328,8 +1481,13 @@ void bindOtherClasses(nb::module_ &m) {
       .def("parse_bitcode",
            [](PymContext &self, PymMemoryBuffer &memBuf) {
              LLVMModuleRef module;
-             auto res = LLVMParseBitcodeInContext2
-                          (self.get(), memBuf.get(), &module) == 0;
+             bool res;
+             {
+               PymContextUse use(self.get());
+               nb::gil_scoped_release release;
+               res = LLVMParseBitcodeInContext2
+                       (self.get(), memBuf.get(), &module) == 0;
+             }
              if (!res) {
                throw std::runtime_error("Error!");
              }
@@ -1343,9 +1501,15 @@ void bindOtherClasses(nb::module_ &m) {
       //  LLVMGetBitcodeModuleInContext2
       .def("get_bitcode_module",
            [](PymContext &self, PymMemoryBuffer &memBuf) {
+             memBuf.ensureTransferable();
              LLVMModuleRef module;
-             auto res = LLVMGetBitcodeModuleInContext2
-                          (self.get(), memBuf.get(), &module) == 0;
+             bool res;
+             {
+               PymContextUse use(self.get());
+               nb::gil_scoped_release release;
+               res = LLVMGetBitcodeModuleInContext2
+                       (self.get(), memBuf.get(), &module) == 0;
+             }
              if (!res) {
                throw std::runtime_error("Error!");
              }
@@ -1353,7 +1517,9 @@ void bindOtherClasses(nb::module_ &m) {
              return PymModule(module);
            },
            "mem_buf"_a,
-           "Reads a module from the given memory buffer.\n"
+           "Reads a module from the given memory buffer, lazily: function bodies "
+           "are only loaded when materialized (see Function.materialize and "
+           "Module.materialize_all).\n"
            "Takes ownership of MemBuf if (and only if) the module was read "
            "successfully")
       .def("create_basic_block",
@@ -1365,6 +1531,7 @@ void bindOtherClasses(nb::module_ &m) {
            "Create a new basic block without inserting it into a function.")
       .def("append_basic_block",
            [](PymContext &self, PymFunction fn, const char *name) {
+             PymIREpoch::bump(self.get());
              return PymBasicBlock(LLVMAppendBasicBlockInContext
                                    (self.get(), fn.get(), name));
            },
@@ -1372,6 +1539,7 @@ void bindOtherClasses(nb::module_ &m) {
            "Append a basic block to the end of a function.")
       .def("insert_basic_block",
            [](PymContext &self, PymBasicBlock bb, const char *name) {
+             PymIREpoch::bump(self.get());
              return PymBasicBlock(LLVMInsertBasicBlockInContext
                                    (self.get(), bb.get(), name));
            },
@@ -1442,7 +1610,12 @@ void bindOtherClasses(nb::module_ &m) {
            })
       .def("__str__",
            [](PymModule &m) {
-             char *str = LLVMPrintModuleToString(m.get());
+             char *str;
+             {
+               PymContextUse use(LLVMGetModuleContext(m.get()));
+               nb::gil_scoped_release release;
+               str = LLVMPrintModuleToString(m.get());
+             }
              std::string strCopy(str);
              LLVMDisposeMessage(str);
              return strCopy;
@@ -1472,9 +1645,10 @@ void bindOtherClasses(nb::module_ &m) {
                    })
       .def_prop_ro("global_variables",
                    [](PymModule &m) {
-                     auto res = LLVMGetFirstGlobal(m.get());
-                     return PymGlobalVariableIterator(PymGlobalVariable(res));
-                   })
+                     return PymGlobalVariableSequence(m.get());
+                   },
+                   "The global variables in the module, as a sequence supporting "
+                   "len, indexing and reversed.")
       .def_prop_ro("first_global_ifunc",
                    [](PymModule &self) -> optional<PymGlobalIFunc> {
                      auto res = LLVMGetFirstGlobalIFunc(self.get());
@@ -1519,10 +1693,10 @@ void bindOtherClasses(nb::module_ &m) {
                    "Obtain an iterator to the last NamedMDNode in a Module.")
       .def_prop_ro("named_metadatas",
                    [](PymModule &m) {
-                     auto res = LLVMGetFirstNamedMetadata(m.get());
-                     return PymNamedMDNodeIterator(PymNamedMDNode(res));
+                     return PymNamedMDNodeSequence(m.get());
                    },
-                   "Obtain an iterator to the first NamedMDNode in a Module.")
+                   "The named metadata in the module, as a sequence supporting "
+                   "len, indexing and reversed.")
       .def_prop_ro("context",
                    [](PymModule &m) {
                      // here we assume that the context got is global context
@@ -1595,8 +1769,10 @@ void bindOtherClasses(nb::module_ &m) {
                    "Obtain an iterator to the last Function in a Module.")
       .def_prop_ro("functions",
                    [](PymModule &m) {
-                     return PymFunctionIterator(PymFunction(LLVMGetFirstFunction(m.get())));
-                   })
+                     return PymFunctionSequence(m.get());
+                   },
+                   "The functions in the module, as a sequence supporting "
+                   "len, indexing and reversed.")
       .def("create_function_pass_manager",
            [](PymModule &self) {
              return PymFunctionPassManager(LLVMCreateFunctionPassManagerForModule(self.get()));
@@ -1611,6 +1787,8 @@ void bindOtherClasses(nb::module_ &m) {
            })
       .def("write_bitcode_to_file",
            [](PymModule &self, const char *path) {
+             PymContextUse use(LLVMGetModuleContext(self.get()));
+             nb::gil_scoped_release release;
              return LLVMWriteBitcodeToFile(self.get(), path);
            },
            "path"_a)
@@ -1618,7 +1796,13 @@ void bindOtherClasses(nb::module_ &m) {
       //  implemented
       .def("write_bitcode_to_memory_buffer",
            [](PymModule &self) {
-             return PymMemoryBuffer(LLVMWriteBitcodeToMemoryBuffer(self.get()));
+             LLVMMemoryBufferRef memBuf;
+             {
+               PymContextUse use(LLVMGetModuleContext(self.get()));
+               nb::gil_scoped_release release;
+               memBuf = LLVMWriteBitcodeToMemoryBuffer(self.get());
+             }
+             return PymMemoryBuffer(memBuf);
            })
       .def("get_intrinsic_declaration",
            [](PymModule &module, unsigned ID, std::vector<PymType> paramTypes) {
@@ -1632,8 +1816,13 @@ void bindOtherClasses(nb::module_ &m) {
            "parameter types must be provided to uniquely identify an overload.")
       .def("verify",
            [](PymModule &self, LLVMVerifierFailureAction action) -> optional<std::string> {
-             char *outMessage;
-             auto res = LLVMVerifyModule(self.get(), action, &outMessage) == 0;
+             char *outMessage = nullptr;
+             bool res;
+             {
+               PymContextUse use(LLVMGetModuleContext(self.get()));
+               nb::gil_scoped_release release;
+               res = LLVMVerifyModule(self.get(), action, &outMessage) == 0;
+             }
              if (!res) {
                if (outMessage) {
                  std::string errMsg(outMessage);
@@ -1652,9 +1841,70 @@ void bindOtherClasses(nb::module_ &m) {
            "Returns:\n"
            "\tIf success, return None. Otherwise, optionally(based on action) return "
            "a human-readable description if any invalid constructs.")
+      .def("verify_parallel",  // c++ extension
+           [](PymModule &self, std::optional<unsigned> maxWorkers) {
+             auto broken = verifyFunctions(self.get(), maxWorkers);
+             nb::list res;
+             for (auto &[fn, message] : broken)
+               res.append(nb::make_tuple(PymFunction(fn), message));
+             return res;
+           },
+           "max_workers"_a = nb::none(),
+           "Verify the functions defined in the module concurrently, using up to "
+           "max_workers native threads (defaults to the number of hardware "
+           "threads). Module level constructs (e.g. global variables and named "
+           "metadata) are not checked, use verify for them.\n\n"
+           "Returns:\n"
+           "\tA list of (function, message) tuples for the functions which are "
+           "broken, in module order. Empty if all of them are valid.")
+      .def("structural_hash",  // c++ extension
+           [](PymModule &self, bool detailed) {
+             uint64_t res;
+             {
+               PymContextUse use(LLVMGetModuleContext(self.get()));
+               nb::gil_scoped_release release;
+               res = llvm::StructuralHash(*llvm::unwrap(self.get()), detailed);
+             }
+             return res;
+           },
+           "detailed"_a = false,
+           "Compute a hash of the structure of the module, combining the "
+           "structural hashes of its global variables and function definitions. "
+           "See Function.structural_hash.\n\n"
+           "Args:\n"
+           "\tdetailed: also hash instruction types and operands, including "
+           "the values of constants.")
+      .def("split",  // c++ extension
+           [](PymModule &self, unsigned n, bool preserveLocals, bool separateContexts,
+              std::optional<unsigned> maxWorkers) {
+             // local symbols referenced across partitions are externalized
+             PymIREpoch::bump(LLVMGetModuleContext(self.get()));
+             return splitModule(self.get(), n, preserveLocals, separateContexts,
+                                maxWorkers);
+           },
+           "n"_a, "preserve_locals"_a = true, "separate_contexts"_a = true,
+           "max_workers"_a = nb::none(),
+           "Split the module into n partitions (some of which may be empty), "
+           "e.g. to generate code for them in parallel. Each global definition "
+           "ends up in exactly one partition and is declared in the others.\n\n"
+           "Args:\n"
+           "\tpreserve_locals: keep every local symbol with the globals that "
+           "reference it instead of externalizing it. Otherwise local symbols "
+           "referenced across partitions are made external (hidden) in this "
+           "module as well.\n"
+           "\tseparate_contexts: move each partition into a new Context of its "
+           "own (through bitcode, on up to max_workers native threads), so that "
+           "the partitions can be used from different threads at the same time. "
+           "Otherwise all of them live in the context of this module.\n\n"
+           "Returns:\n"
+           "\tThe partition modules. With separate_contexts, each module keeps "
+           "its context alive.\n\n"
+           "Raises:\n"
+           "\tValueError: n is 0.")
       .def("add_alias",
            [](PymModule &self, PymType &valueType, unsigned addrSpace, PymValue aliasee,
               const char *name) {
+             PymIREpoch::bump(LLVMGetModuleContext(self.get()));
              return PymGlobalAlias(LLVMAddAlias2
                                     (self.get(), valueType.get(), addrSpace,
                                      aliasee.get(), name));
@@ -1670,11 +1920,13 @@ void bindOtherClasses(nb::module_ &m) {
            "Obtain a GlobalAlias value from by its name.")
       .def("add_global",
            [](PymModule &self, PymType &type, const char *name) {
+             PymIREpoch::bump(LLVMGetModuleContext(self.get()));
              return PymGlobalVariable(LLVMAddGlobal(self.get(), type.get(), name));
            },
            "type"_a, "name"_a = "")
       .def("add_global_in_address_space",
            [](PymModule &self, PymType &type, const char *name, unsigned addressSpace) {
+             PymIREpoch::bump(LLVMGetModuleContext(self.get()));
              return PymGlobalVariable(LLVMAddGlobalInAddressSpace
                                        (self.get(), type.get(), name, addressSpace));
            },
@@ -1686,6 +1938,7 @@ void bindOtherClasses(nb::module_ &m) {
       .def("add_global_indirect_func",
            [](PymModule &self, PymType &type, unsigned addrSpace, PymConstant resolver,
               std::string &name) {
+             PymIREpoch::bump(LLVMGetModuleContext(self.get()));
              return PymGlobalIFunc(LLVMAddGlobalIFunc
                                     (self.get(), name.c_str(), name.size(), type.get(),
                                      addrSpace, resolver.get()));
@@ -1698,6 +1951,7 @@ void bindOtherClasses(nb::module_ &m) {
            })
       .def("add_function",
            [](PymModule &m, PymTypeFunction &functionTy, std::string &name) {
+             PymIREpoch::bump(LLVMGetModuleContext(m.get()));
              return PymFunction(LLVMAddFunction(m.get(), name.c_str(), functionTy.get()));
            },
            "function_type"_a, "name"_a = "",
@@ -1717,6 +1971,7 @@ void bindOtherClasses(nb::module_ &m) {
            "node exists.")
       .def("get_or_insert_named_metadata",
            [](PymModule &m, std::string &name) {
+             PymIREpoch::bump(LLVMGetModuleContext(m.get()));
              return PymNamedMDNode
                       (LLVMGetOrInsertNamedMetadata
                          (m.get(), name.c_str(), name.size()));
@@ -1745,14 +2000,97 @@ void bindOtherClasses(nb::module_ &m) {
            "instance corresponds to a llvm::MDNode.")
       .def("add_named_metadata_operand",
            [](PymModule &m, std::string &name, PymValue &val) {
+             PymIREpoch::bump(LLVMGetModuleContext(m.get()));
              return LLVMAddNamedMetadataOperand(m.get(), name.c_str(), val.get());
            },
            "Add an operand to named metadata.")
       .def("clone",
            [](PymModule &m) {
-             return PymModule(LLVMCloneModule(m.get()));
+             LLVMModuleRef cloned;
+             {
+               PymContextUse use(LLVMGetModuleContext(m.get()));
+               nb::gil_scoped_release release;
+               cloned = LLVMCloneModule(m.get());
+             }
+             return PymModule(cloned);
            },
            "Return an exact copy of the specified module.")
+      .def("materialize_all",  // c++ extension
+           [](PymModule &m) {
+             using namespace llvm;
+             PymIREpoch::bump(LLVMGetModuleContext(m.get()));
+             Error err = [&]() {
+               PymContextUse use(LLVMGetModuleContext(m.get()));
+               nb::gil_scoped_release release;
+               return unwrap(m.get())->materializeAll();
+             }();
+             if (err)
+               throw std::runtime_error(toString(std::move(err)));
+           },
+           "Load the bodies of all functions of a lazily loaded module (e.g. "
+           "Context.get_bitcode_module). Does nothing for a fully loaded module."
+           "\n\n:raises RuntimeError")
+      .def("def_use_graph",  // c++ extension
+           [](PymModule &m) {
+             return exportDefUseGraph(m.get());
+           },
+           "Build the def-use graph of the whole module in C++ and return it as a "
+           "dict of NumPy arrays in CSR form. Besides the uses by instructions, "
+           "it contains the uses of global variable initializers, alias aliasees "
+           "and ifunc resolvers, including the ones inside constants (e.g. a "
+           "function referred to by a vtable initializer). Requires numpy.\n\n"
+           "Keys: the ones of `Function.def_use_graph` except num_instructions "
+           "and num_arguments, and\n"
+           "  - function: for every value id, the index of the function defining "
+           "it (for instructions and arguments), otherwise -1\n"
+           "  - num_global_values\n"
+           "  - value_table: the `ValueTable` mapping value ids back to values\n\n"
+           "Value ids: the global values come first (functions, global variables, "
+           "aliases, ifuncs, each in module order), followed by the instructions "
+           "and arguments of each function, followed by any other value in "
+           "first-seen order.")
+      .def("operand_table",  // c++ extension
+           [](PymModule &m) {
+             return exportOperandTable(m.get());
+           },
+           "Return the operands of all the instructions of this module in one "
+           "call, as a dict of NumPy arrays with one row per instruction (in "
+           "module order). Requires numpy.\n\n"
+           "Keys:\n"
+           "  - instruction_ids: value id of the instruction\n"
+           "  - opcode: Opcode value of the instruction\n"
+           "  - function: index of the containing function\n"
+           "  - operand_offsets, operand_ids: the operands of row i are "
+           "operand_ids[operand_offsets[i]:operand_offsets[i+1]]\n"
+           "  - operand_kinds: ValueKind value of every entry of operand_ids\n"
+           "  - value_kind: ValueKind value of every value id\n"
+           "  - value_table: the `ValueTable` mapping value ids back to values\n\n"
+           "Value ids are the same as the ones of `def_use_graph`.")
+      .def("call_graph",  // c++ extension
+           [](PymModule &m) {
+             return exportCallGraph(m.get());
+           },
+           "Build the call graph of this module with LLVM's CallGraph analysis "
+           "and return it as a dict of NumPy arrays in CSR form. Requires numpy."
+           "\n\n"
+           "Node i < len(functions) is the i-th function of the module. There are "
+           "two more nodes: `external_calling_node` calls every function which "
+           "can be called from outside of the module (or whose address is taken), "
+           "and `calls_external_node` stands for unknown code. A call to a "
+           "declaration is an edge to the node of that declaration, which in turn "
+           "has an edge to `calls_external_node`; indirect calls are edges to "
+           "`calls_external_node` directly.\n\n"
+           "Keys:\n"
+           "  - callee_offsets, callee_targets: the callees of node i are "
+           "callee_targets[callee_offsets[i]:callee_offsets[i+1]], one entry per "
+           "call site\n"
+           "  - caller_offsets, caller_targets\n"
+           "  - scc_offsets, scc_nodes: the strongly connected components in "
+           "bottom-up order (callees before callers), computed by Tarjan's "
+           "algorithm starting from `external_calling_node`\n"
+           "  - scc_has_cycle: whether each component contains a cycle (i.e. "
+           "recursion)\n"
+           "  - num_nodes, external_calling_node, calls_external_node")
       .def("copy_module_flags_metadata",
            [](PymModule &m) {
              size_t Len;
@@ -1786,8 +2124,12 @@ void bindOtherClasses(nb::module_ &m) {
       .def("print_to_file",
            [](PymModule &m, const std::string &filename) {
              char *errorMessage = nullptr;
-             LLVMBool res = LLVMPrintModuleToFile(m.get(), filename.c_str(),
-                                                  &errorMessage);
+             LLVMBool res;
+             {
+               PymContextUse use(LLVMGetModuleContext(m.get()));
+               nb::gil_scoped_release release;
+               res = LLVMPrintModuleToFile(m.get(), filename.c_str(), &errorMessage);
+             }
              bool success = res == 0;
              
              if (!success) {
@@ -8,6 +8,7 @@
 #define BUILDER_BIND_BINARY_OP(NAME, FUNCTION) \
   .def(#NAME, \
       [](PymBuilder &self, PymValue &lhs, PymValue &rhs, const char *name) { \
+        PymIREpoch::bump(getBuilderContext(self.get())); \
         return PymValueAuto(FUNCTION(self.get(), lhs.get(), rhs.get(), name)); \
       }, \
       "lhs"_a, "rhs"_a, "name"_a = "") 
@@ -45,6 +46,7 @@
 #define BUILDER_BIND_CAST_OP(NAME, FUNCTION) \
   .def(#NAME, \
       [](PymBuilder &self, PymValue &val, PymType &destType, const char *name) { \
+        PymIREpoch::bump(getBuilderContext(self.get())); \
         return PymValueAuto(FUNCTION(self.get(), val.get(), destType.get(), name)); \
       }, \
       "val"_a, "dest_type"_a, "name"_a = "") 
@@ -0,0 +1,88 @@
+#include "sequence.h"
+#include "utils.h"
+
+namespace nb = nanobind;
+using namespace nb::literals;
+
+
+/*
+ * WRAP: expression converting `raw` (an element) into the Python side object
+ */
+#define BIND_SEQUENCE_CLASS(ClassName, PythonClassName, Iterator, ReverseIterator, \
+                            WRAP, DOC) \
+  nb::class_<ClassName>(m, PythonClassName, DOC) \
+      .def("__len__", &ClassName::size) \
+      .def("__getitem__", \
+           [](ClassName &self, Py_ssize_t index) { \
+             auto raw = self.at(index); \
+             return WRAP; \
+           }, \
+           "index"_a) \
+      .def("__iter__", \
+           [](ClassName &self) { \
+             return Iterator(self.getContainer()); \
+           }) \
+      .def("__reversed__", \
+           [](ClassName &self) { \
+             return ReverseIterator(self.getContainer()); \
+           });
+
+
+namespace {
+
+/*
+ * Adapt the first/last element functions to the constructors of the iterators
+ * defined by DEFINE_ITERATOR_CLASS, which take a wrapper object
+ */
+template <typename Iterator, typename Wrapper, auto GetFn, typename Container>
+Iterator makeIterator(Container container) {
+  return Iterator(Wrapper(GetFn(container)));
+}
+
+}
+
+
+void bindSequences(nb::module_ &m) {
+  BIND_SEQUENCE_CLASS
+    (PymFunctionSequence, "FunctionSequence",
+     (makeIterator<PymFunctionIterator, PymFunction, LLVMGetFirstFunction>),
+     (makeIterator<PymFunctionReverseIterator, PymFunction, LLVMGetLastFunction>),
+     PymFunction(raw),
+     "The functions of a module. Supports len, indexing and reversed.")
+
+  BIND_SEQUENCE_CLASS
+    (PymGlobalVariableSequence, "GlobalVariableSequence",
+     (makeIterator<PymGlobalVariableIterator, PymGlobalVariable, LLVMGetFirstGlobal>),
+     (makeIterator<PymGlobalVariableReverseIterator, PymGlobalVariable,
+                   LLVMGetLastGlobal>),
+     PymGlobalVariable(raw),
+     "The global variables of a module. Supports len, indexing and reversed.")
+
+  BIND_SEQUENCE_CLASS
+    (PymNamedMDNodeSequence, "NamedMDNodeSequence",
+     (makeIterator<PymNamedMDNodeIterator, PymNamedMDNode, LLVMGetFirstNamedMetadata>),
+     (makeIterator<PymNamedMDNodeReverseIterator, PymNamedMDNode,
+                   LLVMGetLastNamedMetadata>),
+     PymNamedMDNode(raw),
+     "The named metadata of a module. Supports len, indexing and reversed.")
+
+  BIND_SEQUENCE_CLASS
+    (PymBasicBlockSequence, "BasicBlockSequence",
+     [](LLVMValueRef fn) { return PymBasicBlockIterator(LLVMGetFirstBasicBlock(fn)); },
+     [](LLVMValueRef fn) {
+       return PymBasicBlockReverseIterator(LLVMGetLastBasicBlock(fn));
+     },
+     PymBasicBlockAuto(raw),
+     "The basic blocks of a function. Supports len, indexing and reversed.")
+
+  BIND_SEQUENCE_CLASS
+    (PymInstructionSequence, "InstructionSequence",
+     [](LLVMBasicBlockRef bb) {
+       return PymInstructionIterator(LLVMGetFirstInstruction(bb));
+     },
+     [](LLVMBasicBlockRef bb) {
+       return PymInstructionReverseIterator(LLVMGetLastInstruction(bb));
+     },
+     PymInstructionAuto(raw),
+     "The instructions of a basic block. Supports len, indexing and reversed.")
+}
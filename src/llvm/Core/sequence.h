@@ -0,0 +1,157 @@
+#ifndef LLVMPYM_CORE_SEQUENCE_H
+#define LLVMPYM_CORE_SEQUENCE_H
+
+#include <nanobind/nanobind.h>
+#include <llvm-c/Core.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "../types_priv.h"
+
+/*
+ * A random-access view of an LLVM linked list, e.g. the functions of a module.
+ *
+ * The elements are collected on the first `len` or index access and reused
+ * until the list may have changed, which is detected by comparing the
+ * PymIREpoch of the context and the first and last element. Collecting them
+ * never modifies the IR. The collected elements are kept in a PymIREpoch cache
+ * of the container, so all the views of the same container (e.g. the ones
+ * created by accessing `Module.functions` repeatedly) share them.
+ *
+ * `Traits` provides the Container and Element types and context/first/last/next
+ * functions.
+ *
+ * NOTE the cache isn't synchronized, it relies on a context (and so every view
+ * into it) being used by one thread at a time.
+ */
+template <typename Traits>
+class PymSequenceView {
+public:
+  using Container = typename Traits::Container;
+  using Element = typename Traits::Element;
+
+  explicit PymSequenceView(Container container)
+  : container(container), context(Traits::context(container)),
+    cache(PymIREpoch::getCache<Cache>(context, container)) {}
+
+  Container getContainer() const {
+    return container;
+  }
+
+  size_t size() {
+    refresh();
+    return cache->elements.size();
+  }
+
+  Element at(Py_ssize_t index) {
+    refresh();
+    auto num = static_cast<Py_ssize_t>(cache->elements.size());
+    if (index < 0)
+      index += num;
+    if (index < 0 || index >= num)
+      throw nanobind::index_error("index out of range");
+    return cache->elements[index];
+  }
+
+private:
+  struct Fingerprint {
+    uint64_t epoch;
+    Element first;
+    Element last;
+
+    bool operator==(const Fingerprint &other) const {
+      return epoch == other.epoch && first == other.first && last == other.last;
+    }
+  };
+
+  struct Cache {
+    std::vector<Element> elements;
+    Fingerprint fingerprint{};
+    bool valid = false;
+  };
+
+  Fingerprint getFingerprint() const {
+    return {PymIREpoch::get(context), Traits::first(container),
+            Traits::last(container)};
+  }
+
+  void refresh() {
+    auto current = getFingerprint();
+    if (cache->valid && current == cache->fingerprint)
+      return;
+    cache->elements.clear();
+    for (auto e = Traits::first(container); e; e = Traits::next(e))
+      cache->elements.push_back(e);
+    cache->fingerprint = current;
+    cache->valid = true;
+  }
+
+  Container container;
+  LLVMContextRef context;
+  std::shared_ptr<Cache> cache;
+};
+
+
+template <typename ContainerT, typename ElementT>
+struct PymSequenceTraits {
+  using Container = ContainerT;
+  using Element = ElementT;
+};
+
+struct PymFunctionSequenceTraits
+: PymSequenceTraits<LLVMModuleRef, LLVMValueRef> {
+  static constexpr auto context = LLVMGetModuleContext;
+  static constexpr auto first = LLVMGetFirstFunction;
+  static constexpr auto last = LLVMGetLastFunction;
+  static constexpr auto next = LLVMGetNextFunction;
+};
+
+struct PymGlobalVariableSequenceTraits
+: PymSequenceTraits<LLVMModuleRef, LLVMValueRef> {
+  static constexpr auto context = LLVMGetModuleContext;
+  static constexpr auto first = LLVMGetFirstGlobal;
+  static constexpr auto last = LLVMGetLastGlobal;
+  static constexpr auto next = LLVMGetNextGlobal;
+};
+
+struct PymNamedMDNodeSequenceTraits
+: PymSequenceTraits<LLVMModuleRef, LLVMNamedMDNodeRef> {
+  static constexpr auto context = LLVMGetModuleContext;
+  static constexpr auto first = LLVMGetFirstNamedMetadata;
+  static constexpr auto last = LLVMGetLastNamedMetadata;
+  static constexpr auto next = LLVMGetNextNamedMetadata;
+};
+
+struct PymBasicBlockSequenceTraits
+: PymSequenceTraits<LLVMValueRef, LLVMBasicBlockRef> {
+  static LLVMContextRef context(LLVMValueRef fn) {
+    return LLVMGetTypeContext(LLVMTypeOf(fn));
+  }
+
+  static constexpr auto first = LLVMGetFirstBasicBlock;
+  static constexpr auto last = LLVMGetLastBasicBlock;
+  static constexpr auto next = LLVMGetNextBasicBlock;
+};
+
+struct PymInstructionSequenceTraits
+: PymSequenceTraits<LLVMBasicBlockRef, LLVMValueRef> {
+  static LLVMContextRef context(LLVMBasicBlockRef bb) {
+    return LLVMGetTypeContext(LLVMTypeOf(LLVMBasicBlockAsValue(bb)));
+  }
+
+  static constexpr auto first = LLVMGetFirstInstruction;
+  static constexpr auto last = LLVMGetLastInstruction;
+  static constexpr auto next = LLVMGetNextInstruction;
+};
+
+using PymFunctionSequence = PymSequenceView<PymFunctionSequenceTraits>;
+using PymGlobalVariableSequence = PymSequenceView<PymGlobalVariableSequenceTraits>;
+using PymNamedMDNodeSequence = PymSequenceView<PymNamedMDNodeSequenceTraits>;
+using PymBasicBlockSequence = PymSequenceView<PymBasicBlockSequenceTraits>;
+using PymInstructionSequence = PymSequenceView<PymInstructionSequenceTraits>;
+
+
+void bindSequences(nanobind::module_ &m);
+
+
+#endif
@@ -1,9 +1,68 @@
 #include "utils.h"
 
 #include <llvm-c/IRReader.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Intrinsics.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Transforms/Utils/SplitModule.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 
-PymMetadataAsValue* getMoreSpcMetadataAsValue(LLVMValueRef raw) {
+namespace nb = nanobind;
+
+
+namespace {
+
+/**
+ * A llvm::MemoryBuffer whose contents is owned by a Python object
+ */
+class PyBufferMemoryBuffer : public llvm::MemoryBuffer {
+public:
+  PyBufferMemoryBuffer(Py_buffer view, size_t size, const std::string &name)
+  : view(view), name(name) {
+    auto start = static_cast<const char *>(view.buf);
+    init(start, start + size, size != static_cast<size_t>(view.len));
+  }
+
+  ~PyBufferMemoryBuffer() override {
+    // may be disposed by LLVM from a call which released the GIL
+    nb::gil_scoped_acquire acquire;
+    PyBuffer_Release(&view);
+  }
+
+  llvm::StringRef getBufferIdentifier() const override {
+    return name;
+  }
+
+  BufferKind getBufferKind() const override {
+    return MemoryBuffer_Malloc;
+  }
+
+private:
+  Py_buffer view;
+  std::string name;
+};
+
+
+PymMetadataAsValue* createMetadataAsValue(LLVMValueRef raw) {
   if (auto v = LLVMIsAMDNode(raw)) {
     return new PymMDNodeValue(v);
   } else if (auto v = LLVMIsAMDString(raw)) {
@@ -13,73 +72,73 @@ PymMetadataAsValue* getMoreSpcMetadataAsValue(LLVMValueRef raw) {
 }
 
 
-/**
- * NOTE only mapping needed specific instruction sub-classes
- * add the order here is according to `PY_FOR_EACH_VALUE_CLASS_RELATIONSHIP` macro
- * in Types.h
- * 
- * @param Inst: should be of LLVMInstructionValueKind
+using ValueFactory = PymValue *(*)(LLVMValueRef);
+
+template <typename T>
+PymValue *constructValue(LLVMValueRef raw) {
+  return new T(raw);
+}
+
+// larger than any LLVMOpcode / LLVMValueKind
+constexpr std::size_t OpcodeTableSize = 128;
+constexpr std::size_t ValueKindTableSize = 64;
+
+/*
+ * Dispatch tables from opcode (value kind) to the constructor of the most
+ * specific wrapper class, generated from `PY_FOR_EACH_OPCODE_CLASS` and
+ * `PY_FOR_EACH_VALUE_KIND_CLASS` in types_priv.h
  */
-PymInstruction* PymInstructionAuto(LLVMValueRef inst) {
-  LLVMOpcode opcode = LLVMGetInstructionOpcode(inst);
-  switch (opcode) {
-  case LLVMCall:
-    return new PymCallInst(inst);
-  case LLVMInvoke:
-    return new PymInvokeInst(inst);
-
-  case LLVMFCmp:
-    return new PymFCmpInst(inst);
-  case LLVMICmp:
-    return new PymICmpInst(inst);
-  case LLVMGetElementPtr:
-    return new PymGetElementPtrInst(inst);
-  case LLVMPHI:
-    return new PymPHINode(inst);
-  case LLVMShuffleVector:
-    return new PymShuffleVectorInst(inst);
-  case LLVMRet:
-    return new PymReturnInst(inst);
-  case LLVMSwitch:
-    return new PymSwitchInst(inst);
-  case LLVMCatchSwitch:
-    return new PymCatchSwitchInst(inst);
-  case LLVMCleanupRet:
-    return new PymCleanupReturnInst(inst);
-  // no kind corresponding to PymFuncletPadInst
-  case LLVMCatchPad:
-    return new PymCatchPadInst(inst);
-  case LLVMAlloca:
-    return new PymAllocaInst(inst);
-  case LLVMInsertValue:
-    return new PymInsertValueInst(inst);
-  case LLVMExtractValue:
-    return new PymExtractValueInst(inst);
-  case LLVMBr:
-    return new PymBranchInst(inst);
-  case LLVMIndirectBr:
-    return new PymIndirectBrInst(inst);
-  case LLVMLandingPad:
-    return new PymLandingPadInst(inst);
-  case LLVMLoad:
-    return new PymLoadInst(inst);
-  case LLVMStore:
-    return new PymStoreInst(inst);
-  case LLVMAtomicRMW:
-    return new PymAtomicRMWInst(inst);
-  case LLVMAtomicCmpXchg:
-    return new PymAtomicCmpXchgInst(inst);
-  case LLVMFence:
-    return new PymFenceInst(inst);
+constexpr std::array<ValueFactory, OpcodeTableSize> makeOpcodeTable() {
+  std::array<ValueFactory, OpcodeTableSize> table{};
+  for (auto &entry : table)
+    entry = &constructValue<PymInstruction>;
 
-  default:
+#define SET_OPCODE_ENTRY(Opcode, ClassName) \
+  static_assert(Opcode < OpcodeTableSize); \
+  table[Opcode] = &constructValue<ClassName>;
+  PY_FOR_EACH_OPCODE_CLASS(SET_OPCODE_ENTRY)
+#undef SET_OPCODE_ENTRY
+
+  return table;
+}
+
+constexpr auto opcodeTable = makeOpcodeTable();
+
+PymInstruction* createInstruction(LLVMValueRef inst, LLVMOpcode opcode) {
+  auto index = static_cast<std::size_t>(opcode);
+  if (index >= OpcodeTableSize)
     return new PymInstruction(inst);
-  }
+  return static_cast<PymInstruction*>(opcodeTable[index](inst));
 }
 
+PymValue *constructMetadataAsValue(LLVMValueRef raw) {
+  return createMetadataAsValue(raw);
+}
 
+PymValue *constructInstruction(LLVMValueRef raw) {
+  return createInstruction(raw, LLVMGetInstructionOpcode(raw));
+}
 
-PymType* PymTypeAuto(LLVMTypeRef rawType) {
+constexpr std::array<ValueFactory, ValueKindTableSize> makeValueKindTable() {
+  std::array<ValueFactory, ValueKindTableSize> table{};
+  for (auto &entry : table)
+    entry = &constructValue<PymValue>;
+
+#define SET_VALUE_KIND_ENTRY(Kind, ClassName) \
+  static_assert(Kind < ValueKindTableSize); \
+  table[Kind] = &constructValue<ClassName>;
+  PY_FOR_EACH_VALUE_KIND_CLASS(SET_VALUE_KIND_ENTRY)
+#undef SET_VALUE_KIND_ENTRY
+
+  table[LLVMMetadataAsValueValueKind] = &constructMetadataAsValue;
+  table[LLVMInstructionValueKind] = &constructInstruction;
+  return table;
+}
+
+constexpr auto valueKindTable = makeValueKindTable();
+
+
+PymType* createType(LLVMTypeRef rawType) {
   LLVMTypeKind kind = LLVMGetTypeKind(rawType);
   switch (kind) {
   case LLVMVoidTypeKind:
@@ -127,63 +186,199 @@ PymType* PymTypeAuto(LLVMTypeRef rawType) {
  * It seems like the enum type doesn't cover all the sub-classes,
  * so user may still need to do a manual cast using `to_XXX` method
  */
+PymValue* createValue(LLVMValueRef rawValue, LLVMValueKind kind) {
+  auto index = static_cast<std::size_t>(kind);
+  if (index >= ValueKindTableSize)
+    return new PymValue(rawValue);
+  return valueKindTable[index](rawValue);
+}
+
+
+LLVMContextRef getValueContext(LLVMValueRef raw) {
+  return LLVMGetTypeContext(LLVMTypeOf(raw));
+}
+
+/*
+ * Describes which wrapper class `create*` functions above choose for a value
+ */
+unsigned getValueInternTag(LLVMValueKind kind, unsigned opcode = 0) {
+  return (static_cast<unsigned>(kind) << 16) | opcode;
+}
+
+/*
+ * Return the interned wrapper of `raw`, creating (and interning) one with
+ * `create` if there is none yet.
+ */
+template <typename Base, typename Ref, typename Create>
+Base *getInterned(LLVMContextRef ctx, Ref raw, unsigned tag, Create create) {
+  PymContextUse use(ctx);
+  auto &table = Base::internTable();
+  if (auto obj = table.find(ctx, raw, tag))
+    return obj;
+  Base *obj = create(raw);
+  table.insert(ctx, raw, tag, obj);
+  return obj;
+}
+
+}
+
+
+PymInternTable<LLVMValueRef, PymValue> &PymValue::internTable() {
+  // never destroyed, since wrappers may outlive static destruction
+  static auto *table = new PymInternTable<LLVMValueRef, PymValue>();
+  return *table;
+}
+
+PymInternTable<LLVMTypeRef, PymType> &PymType::internTable() {
+  static auto *table = new PymInternTable<LLVMTypeRef, PymType>();
+  return *table;
+}
+
+PymInternTable<LLVMBasicBlockRef, PymBasicBlock> &PymBasicBlock::internTable() {
+  static auto *table = new PymInternTable<LLVMBasicBlockRef, PymBasicBlock>();
+  return *table;
+}
+
+void forgetInternedObjects(LLVMContextRef ctx) {
+  PymValue::internTable().forgetContext(ctx);
+  PymType::internTable().forgetContext(ctx);
+  PymBasicBlock::internTable().forgetContext(ctx);
+}
+
+
+/*
+ * The Python diagnostic handler of a context. Its address is handed to LLVM as
+ * the diagnostic context, so it stays at the same place until it is replaced
+ * or the context is disposed.
+ */
+struct PymDiagnosticHandler {
+  nb::object handler;
+  nb::object context;
+};
+
+namespace {
+
+std::mutex diagnosticHandlersMutex;
+std::unordered_map<LLVMContextRef, std::unique_ptr<PymDiagnosticHandler>>
+  diagnosticHandlers;
+
+void callDiagnosticHandler(LLVMDiagnosticInfoRef di, void *opaque) {
+  // diagnostics may be emitted by a call that released the GIL
+  nb::gil_scoped_acquire acquire;
+  auto *h = static_cast<PymDiagnosticHandler *>(opaque);
+  try {
+    h->handler(PymDiagnosticInfo(di), h->context);
+  } catch (nb::python_error &e) {
+    // must not propagate through LLVM
+    e.discard_as_unraisable(h->handler);
+  }
+}
+
+PymDiagnosticHandler *findDiagnosticHandler(LLVMContextRef ctx) {
+  std::lock_guard<std::mutex> lock(diagnosticHandlersMutex);
+  auto it = diagnosticHandlers.find(ctx);
+  return it == diagnosticHandlers.end() ? nullptr : it->second.get();
+}
+
+}
+
+void setDiagnosticHandler(LLVMContextRef ctx, nb::object handler,
+                          nb::object diagnosticContext) {
+  auto h = std::make_unique<PymDiagnosticHandler>
+             (PymDiagnosticHandler{std::move(handler), std::move(diagnosticContext)});
+  std::unique_ptr<PymDiagnosticHandler> old;
+  {
+    std::lock_guard<std::mutex> lock(diagnosticHandlersMutex);
+    LLVMContextSetDiagnosticHandler(ctx, callDiagnosticHandler, h.get());
+    old = std::exchange(diagnosticHandlers[ctx], std::move(h));
+  }
+}
+
+nb::object getDiagnosticHandler(LLVMContextRef ctx) {
+  auto h = findDiagnosticHandler(ctx);
+  return h ? h->handler : nb::none();
+}
+
+nb::object getDiagnosticContext(LLVMContextRef ctx) {
+  auto h = findDiagnosticHandler(ctx);
+  return h ? h->context : nb::none();
+}
+
+void forgetDiagnosticHandler(LLVMContextRef ctx) {
+  std::unique_ptr<PymDiagnosticHandler> h;
+  {
+    std::lock_guard<std::mutex> lock(diagnosticHandlersMutex);
+    auto it = diagnosticHandlers.find(ctx);
+    if (it == diagnosticHandlers.end())
+      return;
+    h = std::move(it->second);
+    diagnosticHandlers.erase(it);
+  }
+  // the Python objects may only be released while holding the GIL
+  nb::gil_scoped_acquire acquire;
+  h.reset();
+}
+
+
+void forgetInternedValue(LLVMValueRef raw) {
+  PymValue::internTable().forget(getValueContext(raw), raw);
+}
+
+void forgetInternedBasicBlock(LLVMBasicBlockRef raw) {
+  auto ctx = getValueContext(LLVMBasicBlockAsValue(raw));
+  PymValue::internTable().forget(ctx, LLVMBasicBlockAsValue(raw));
+  PymBasicBlock::internTable().forget(ctx, raw);
+}
+
+LLVMContextRef getBasicBlockContext(LLVMBasicBlockRef bb) {
+  return getValueContext(LLVMBasicBlockAsValue(bb));
+}
+
+LLVMContextRef getBuilderContext(LLVMBuilderRef builder) {
+  return llvm::wrap(&llvm::unwrap(builder)->getContext());
+}
+
+
+PymMetadataAsValue* getMoreSpcMetadataAsValue(LLVMValueRef raw) {
+  return static_cast<PymMetadataAsValue*>
+           (getInterned<PymValue>(getValueContext(raw), raw,
+                                  getValueInternTag(LLVMMetadataAsValueValueKind),
+                                  createMetadataAsValue));
+}
+
+PymInstruction* PymInstructionAuto(LLVMValueRef inst) {
+  LLVMOpcode opcode = LLVMGetInstructionOpcode(inst);
+  return static_cast<PymInstruction*>
+           (getInterned<PymValue>(getValueContext(inst), inst,
+                                  getValueInternTag(LLVMInstructionValueKind, opcode),
+                                  [opcode](LLVMValueRef raw) {
+                                    return createInstruction(raw, opcode);
+                                  }));
+}
+
+PymType* PymTypeAuto(LLVMTypeRef rawType) {
+  return getInterned<PymType>(LLVMGetTypeContext(rawType), rawType,
+                              static_cast<unsigned>(LLVMGetTypeKind(rawType)),
+                              createType);
+}
+
 PymValue* PymValueAuto(LLVMValueRef rawValue) {
   LLVMValueKind kind = LLVMGetValueKind(rawValue);
-  switch (kind) {
-  case LLVMArgumentValueKind:
-    return new PymArgument(rawValue);
-  case LLVMBasicBlockValueKind:
-    return new PymBasicBlockValue(rawValue);
-  // case LLVMMemoryUseValueKind:
-  // case LLVMMemoryDefValueKind:
-  // case LLVMMemoryPhiValueKind:
-
-  case LLVMFunctionValueKind:
-    return new PymFunction(rawValue);
-  case LLVMGlobalAliasValueKind:
-    return new PymGlobalAlias(rawValue);
-  case LLVMGlobalIFuncValueKind:
-    return new PymGlobalIFunc(rawValue);
-  case LLVMGlobalVariableValueKind:
-    return new PymGlobalVariable(rawValue);
-  // case LLVMBlockAddressValueKind:
-  case LLVMConstantExprValueKind:
-    return new PymConstantExpr(rawValue);
-  case LLVMConstantArrayValueKind:
-    return new PymConstantArray(rawValue);
-  case LLVMConstantStructValueKind:
-    return new PymConstantStruct(rawValue);
-  case LLVMConstantVectorValueKind:
-    return new PymConstantVector(rawValue);
-
-  case LLVMUndefValueValueKind:
-    return new PymUndefValue(rawValue);
-  case LLVMConstantDataArrayValueKind:
-    return new PymConstantDataArray(rawValue);
-  case LLVMConstantDataVectorValueKind:
-    return new PymConstantDataVector(rawValue);
-  case LLVMConstantIntValueKind:
-    return new PymConstantInt(rawValue);
-  case LLVMConstantFPValueKind:
-    return new PymConstantFP(rawValue);
-  case LLVMConstantTokenNoneValueKind:
-  case LLVMConstantAggregateZeroValueKind:
-  case LLVMConstantPointerNullValueKind:
-    return new PymConstant(rawValue);
-
-  case LLVMMetadataAsValueValueKind:
-    return getMoreSpcMetadataAsValue(rawValue);
-  case LLVMInlineAsmValueKind:
-    return new PymInlineAsm(rawValue);
-
-  case LLVMInstructionValueKind:
+  if (kind == LLVMInstructionValueKind)
     return PymInstructionAuto(rawValue);
-  case LLVMPoisonValueValueKind:
-    return new PymPoisonValue(rawValue);
-  // case LLVMConstantTargetNoneValueKind: // 
-  default:
-    return new PymValue(rawValue);
-  }
+  return getInterned<PymValue>(getValueContext(rawValue), rawValue,
+                               getValueInternTag(kind),
+                               [kind](LLVMValueRef raw) {
+                                 return createValue(raw, kind);
+                               });
+}
+
+PymBasicBlock* PymBasicBlockAuto(LLVMBasicBlockRef rawBB) {
+  if (!rawBB)
+    return new PymBasicBlock(rawBB);
+  return getInterned<PymBasicBlock>
+           (getValueContext(LLVMBasicBlockAsValue(rawBB)), rawBB, 0,
+            [](LLVMBasicBlockRef bb) { return new PymBasicBlock(bb); });
 }
 
 PymAttribute* PymAttributeAuto(LLVMAttributeRef rawValue) {
@@ -198,10 +393,27 @@ PymAttribute* PymAttributeAuto(LLVMAttributeRef rawValue) {
   }
 }
 
-PymModule parseIR(LLVMContextRef ctx, LLVMMemoryBufferRef memBuf) {
+PymModule parseIR(LLVMContextRef ctx, LLVMMemoryBufferRef memBuf,
+                  bool nullTerminated) {
+  if (!nullTerminated) {
+    auto buf = llvm::unwrap(memBuf);
+    if (!llvm::isBitcode(reinterpret_cast<const unsigned char *>(buf->getBufferStart()),
+                         reinterpret_cast<const unsigned char *>(buf->getBufferEnd()))) {
+      auto copy = llvm::MemoryBuffer::getMemBufferCopy(buf->getBuffer(),
+                                                        buf->getBufferIdentifier());
+      delete buf;
+      memBuf = llvm::wrap(copy.release());
+    }
+  }
+
   LLVMModuleRef m = nullptr;
   char *errMsg = nullptr;
-  bool success = LLVMParseIRInContext(ctx, memBuf, &m, &errMsg) == 0;
+  bool success;
+  {
+    PymContextUse use(ctx);
+    nanobind::gil_scoped_release release;
+    success = LLVMParseIRInContext(ctx, memBuf, &m, &errMsg) == 0;
+  }
 
   if (!success) {
     std::string errorMessage;
@@ -213,3 +425,313 @@ PymModule parseIR(LLVMContextRef ctx, LLVMMemoryBufferRef memBuf) {
 
   return PymModule(m);
 }
+
+
+LLVMMemoryBufferRef createMemoryBufferFromFile(const std::string &path, bool mmap) {
+  auto res = [&]() {
+    nb::gil_scoped_release release;
+    // a volatile file is never memory mapped
+    return llvm::MemoryBuffer::getFile(path, /*IsText=*/false,
+                                       /*RequiresNullTerminator=*/true,
+                                       /*IsVolatile=*/!mmap);
+  }();
+  if (!res)
+    throw std::runtime_error(fmt::format("{}: {}", path, res.getError().message()));
+  return llvm::wrap(res->release());
+}
+
+PymModule parseBitcodeFile(LLVMContextRef ctx, const std::string &path, bool lazy) {
+  std::unique_ptr<llvm::MemoryBuffer> memBuf
+    (llvm::unwrap(createMemoryBufferFromFile(path, true)));
+  std::string errorMessage;
+  LLVMModuleRef m = nullptr;
+  {
+    PymContextUse use(ctx);
+    nb::gil_scoped_release release;
+    // NOTE LLVMParseBitcodeInContext2 reports errors through the context, whose
+    // default diagnostic handler aborts the process
+    auto res = lazy
+      ? llvm::getOwningLazyBitcodeModule(std::move(memBuf), *llvm::unwrap(ctx))
+      : llvm::parseBitcodeFile(memBuf->getMemBufferRef(), *llvm::unwrap(ctx));
+    if (res)
+      m = llvm::wrap(res->release());
+    else
+      errorMessage = llvm::toString(res.takeError());
+    memBuf.reset();
+  }
+  if (!m)
+    throw std::runtime_error(fmt::format("{}: {}", path, errorMessage));
+  return PymModule(m);
+}
+
+LLVMMemoryBufferRef createMemoryBufferFromPyBuffer
+  (nb::handle obj, const std::string &bufferName, bool requiresNullTerminator) {
+  Py_buffer view;
+  if (PyObject_GetBuffer(obj.ptr(), &view, PyBUF_SIMPLE) != 0)
+    throw nb::python_error();
+
+  size_t size = static_cast<size_t>(view.len);
+  if (requiresNullTerminator) {
+    auto start = static_cast<const char *>(view.buf);
+    if (size == 0 || start[size - 1] != '\0') {
+      PyBuffer_Release(&view);
+      throw nb::value_error("The buffer is required to end with a null byte.");
+    }
+    size--;
+  }
+
+  return llvm::wrap(new PyBufferMemoryBuffer(view, size, bufferName));
+}
+
+namespace {
+
+/*
+ * An input of parseIntoOwnContexts, either a file or a buffer owned by the
+ * calling thread, so that no Python object is touched by the workers.
+ * `source` keeps the MemoryBuffer object a borrowed `buffer` points into alive
+ * until the inputs are destroyed (with the GIL held).
+ */
+struct ParseInput {
+  std::string path;
+  std::unique_ptr<llvm::MemoryBuffer> owned;
+  std::optional<llvm::MemoryBufferRef> buffer;
+  nb::object source;
+};
+
+/*
+ * Parse every input into a module in a new context of its own, on up to
+ * `maxWorkers` threads. Returns the modules in the order of the inputs, each
+ * keeping its context alive.
+ */
+nb::list parseIntoOwnContexts(std::vector<ParseInput> &items,
+                              std::optional<unsigned> maxWorkers) {
+  size_t num = items.size();
+  size_t workers = maxWorkers.value_or(std::thread::hardware_concurrency());
+  workers = std::clamp<size_t>(workers, 1, std::max<size_t>(num, 1));
+
+  std::vector<llvm::LLVMContext *> contexts(num, nullptr);
+  std::vector<llvm::Module *> modules(num, nullptr);
+  std::atomic<size_t> next{0};
+  std::atomic<bool> failed{false};
+  std::mutex errorMutex;
+  size_t errorIndex = num;
+  std::string errorMessage;
+
+  auto work = [&]() {
+    size_t i;
+    while (!failed && (i = next++) < num) {
+      auto &input = items[i];
+      auto *ctx = new llvm::LLVMContext();
+      llvm::SMDiagnostic err;
+      // both parse either textual IR or bitcode
+      auto m = input.buffer ? llvm::parseIR(*input.buffer, err, *ctx)
+                            : llvm::parseIRFile(input.path, err, *ctx);
+      if (!m) {
+        std::string message;
+        llvm::raw_string_ostream os(message);
+        err.print(nullptr, os, /*ShowColors=*/false);
+        os.flush();
+        delete ctx;
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (i < errorIndex) {
+          errorIndex = i;
+          errorMessage = std::move(message);
+        }
+        failed = true;
+        break;
+      }
+      contexts[i] = ctx;
+      modules[i] = m.release();
+    }
+  };
+
+  {
+    nb::gil_scoped_release release;
+    if (workers == 1) {
+      work();
+    } else {
+      std::vector<std::thread> threads;
+      threads.reserve(workers);
+      for (size_t w = 0; w < workers; w++)
+        threads.emplace_back(work);
+      for (auto &t : threads)
+        t.join();
+    }
+  }
+
+  if (failed) {
+    for (size_t i = 0; i < num; i++) {
+      delete modules[i];
+      delete contexts[i];
+    }
+    throw std::runtime_error(errorMessage);
+  }
+
+  nb::list res;
+  for (size_t i = 0; i < num; i++) {
+    nb::object ctx = nb::cast(PymContext(llvm::wrap(contexts[i]), false));
+    nb::object m = nb::cast(PymModule(llvm::wrap(modules[i])));
+    // nothing else refers to the context, which must outlive the module
+    nb::detail::keep_alive(m.ptr(), ctx.ptr());
+    res.append(m);
+  }
+  return res;
+}
+
+}
+
+nb::list parseMany(nb::iterable inputs, std::optional<unsigned> maxWorkers) {
+  std::vector<ParseInput> items;
+  for (nb::handle obj : inputs) {
+    ParseInput input;
+    if (nb::isinstance<nb::str>(obj) || nb::hasattr(obj, "__fspath__")) {
+      nb::object path = nb::steal(PyOS_FSPath(obj.ptr()));
+      if (!path.is_valid())
+        throw nb::python_error();
+      if (!nb::isinstance<nb::str>(path))
+        throw nb::type_error("parse_many: bytes paths are not supported.");
+      input.path = nb::cast<std::string>(path);
+      items.push_back(std::move(input));
+      continue;
+    }
+
+    auto name = fmt::format("<buffer {}>", items.size());
+    llvm::MemoryBufferRef ref;
+    if (nb::isinstance<PymMemoryBuffer>(obj)) {
+      auto &memBuf = nb::cast<PymMemoryBuffer &>(obj);
+      if (memBuf.consumed())
+        throw std::runtime_error("The memory buffer has already been consumed.");
+      ref = llvm::unwrap(memBuf.get())->getMemBufferRef();
+      // the iteration drops its reference, e.g. for a generator
+      input.source = nb::borrow(obj);
+    } else {
+      input.owned.reset(llvm::unwrap(createMemoryBufferFromPyBuffer(obj, name, false)));
+      ref = input.owned->getMemBufferRef();
+    }
+    // the IR lexer relies on a null terminator, which a borrowed buffer may not
+    // have; bitcode is used in place
+    if (llvm::isBitcode(reinterpret_cast<const unsigned char *>(ref.getBufferStart()),
+                        reinterpret_cast<const unsigned char *>(ref.getBufferEnd()))) {
+      input.buffer = ref;
+    } else {
+      input.owned = llvm::MemoryBuffer::getMemBufferCopy(ref.getBuffer(), name);
+      input.buffer = input.owned->getMemBufferRef();
+    }
+    items.push_back(std::move(input));
+  }
+
+  return parseIntoOwnContexts(items, maxWorkers);
+}
+
+nb::list splitModule(LLVMModuleRef m, unsigned n, bool preserveLocals,
+                     bool separateContexts, std::optional<unsigned> maxWorkers) {
+  if (n == 0)
+    throw nb::value_error("The number of partitions must be positive.");
+
+  std::vector<std::unique_ptr<llvm::Module>> parts;
+  std::vector<ParseInput> items;
+  {
+    PymContextUse use(LLVMGetModuleContext(m));
+    nb::gil_scoped_release release;
+    llvm::SplitModule(*llvm::unwrap(m), n,
+                      [&](std::unique_ptr<llvm::Module> part) {
+                        parts.push_back(std::move(part));
+                      },
+                      preserveLocals);
+
+    if (separateContexts) {
+      // move each partition into a context of its own through bitcode, like
+      // LTO parallel code generation does
+      for (auto &part : parts) {
+        llvm::SmallVector<char, 0> bitcode;
+        llvm::raw_svector_ostream os(bitcode);
+        llvm::WriteBitcodeToFile(*part, os);
+        part.reset();
+
+        ParseInput input;
+        input.owned = llvm::MemoryBuffer::getMemBufferCopy
+                        (llvm::StringRef(bitcode.data(), bitcode.size()),
+                         "<partition>");
+        input.buffer = input.owned->getMemBufferRef();
+        items.push_back(std::move(input));
+      }
+    }
+  }
+
+  if (separateContexts)
+    return parseIntoOwnContexts(items, maxWorkers);
+
+  nb::list res;
+  for (auto &part : parts)
+    res.append(nb::cast(PymModule(llvm::wrap(part.release()))));
+  return res;
+}
+
+std::vector<std::pair<LLVMValueRef, std::string>>
+verifyFunctions(LLVMModuleRef m, std::optional<unsigned> maxWorkers) {
+  auto &mod = *llvm::unwrap(m);
+  std::vector<llvm::Function *> funcs;
+  for (auto &f : mod) {
+    // functions which are not materialized yet are skipped, materializing
+    // them would change the module
+    if (!f.isDeclaration() && !f.isMaterializable())
+      funcs.push_back(&f);
+  }
+
+  size_t num = funcs.size();
+  size_t workers = maxWorkers.value_or(std::thread::hardware_concurrency());
+  workers = std::clamp<size_t>(workers, 1, std::max<size_t>(num, 1));
+
+  std::vector<std::string> messages(num);
+  std::vector<char> broken(num, 0);
+  std::atomic<size_t> next{0};
+
+  auto work = [&]() {
+    size_t i;
+    while ((i = next++) < num) {
+      llvm::raw_string_ostream os(messages[i]);
+      broken[i] = llvm::verifyFunction(*funcs[i], &os);
+      os.flush();
+    }
+  };
+
+  {
+    PymContextUse use(LLVMGetModuleContext(m));
+    nb::gil_scoped_release release;
+
+    // The verifier only reads the IR, except for checking calls to overloaded
+    // intrinsics: matching their signatures may create types in the context
+    // and mangling their names may record a name in the module. Do that once
+    // for every such intrinsic here, so that the workers only find them.
+    for (auto &f : mod) {
+      auto id = f.getIntrinsicID();
+      if (id == llvm::Intrinsic::not_intrinsic || !llvm::Intrinsic::isOverloaded(id))
+        continue;
+      llvm::SmallVector<llvm::Intrinsic::IITDescriptor, 8> table;
+      llvm::Intrinsic::getIntrinsicInfoTableEntries(id, table);
+      llvm::ArrayRef<llvm::Intrinsic::IITDescriptor> tableRef = table;
+      llvm::SmallVector<llvm::Type *, 4> argTys;
+      if (llvm::Intrinsic::matchIntrinsicSignature(f.getFunctionType(), tableRef, argTys)
+            == llvm::Intrinsic::MatchIntrinsicTypes_Match)
+        llvm::Intrinsic::getName(id, argTys, &mod, f.getFunctionType());
+    }
+
+    if (workers == 1) {
+      work();
+    } else {
+      std::vector<std::thread> threads;
+      threads.reserve(workers);
+      for (size_t w = 0; w < workers; w++)
+        threads.emplace_back(work);
+      for (auto &t : threads)
+        t.join();
+    }
+  }
+
+  std::vector<std::pair<LLVMValueRef, std::string>> res;
+  for (size_t i = 0; i < num; i++) {
+    if (broken[i])
+      res.emplace_back(llvm::wrap(funcs[i]), std::move(messages[i]));
+  }
+  return res;
+}
@@ -5,7 +5,10 @@
 #include <llvm-c/Core.h>
 #include "../types_priv.h"
 #include <fmt/core.h>
+#include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
 
 /**
@@ -44,15 +47,122 @@ inline std::string gen_value_repr(const char *typeName, PymValue &v) {
   return fmt::format("<{} name='{}'>", typeName, name);
 }
 
+/*
+ * The `*Auto` functions below return the wrapper of the most specific class for
+ * a reference. Wrappers are interned per context: as long as a wrapper is alive,
+ * the same object is returned for the same reference.
+ */
+
 PymInstruction* PymInstructionAuto(LLVMValueRef inst);
 
 PymType* PymTypeAuto(LLVMTypeRef rawType);
 
 PymValue* PymValueAuto(LLVMValueRef rawValue);
 
+PymBasicBlock* PymBasicBlockAuto(LLVMBasicBlockRef rawBB);
+
+/*
+ * Drop the interned wrapper of a value (basic block) which is going to be
+ * erased or deleted. Must be called before the deletion.
+ */
+void forgetInternedValue(LLVMValueRef raw);
+
+void forgetInternedBasicBlock(LLVMBasicBlockRef raw);
+
+LLVMContextRef getBasicBlockContext(LLVMBasicBlockRef bb);
+
+/*
+ * The context a Builder creates instructions in
+ */
+LLVMContextRef getBuilderContext(LLVMBuilderRef builder);
+
+/*
+ * Make `handler` the diagnostic handler of `ctx`. It is called (with the GIL
+ * held) with a DiagnosticInfo and `diagnosticContext`. Each context keeps its
+ * own handler until it is replaced or the context is disposed.
+ */
+void setDiagnosticHandler(LLVMContextRef ctx, nanobind::object handler,
+                          nanobind::object diagnosticContext);
+
+/*
+ * The handler (diagnostic context) given to setDiagnosticHandler, or None
+ */
+nanobind::object getDiagnosticHandler(LLVMContextRef ctx);
+
+nanobind::object getDiagnosticContext(LLVMContextRef ctx);
+
 PymAttribute* PymAttributeAuto(LLVMAttributeRef rawValue);
 
-PymModule parseIR(LLVMContextRef ctx, LLVMMemoryBufferRef memBuf);
+/**
+ * Parse textual IR or bitcode in `memBuf` (which is consumed) into a module
+ * inside `ctx`. Textual IR in a buffer which isn't null terminated is copied
+ * first, as the IR lexer relies on the terminator.
+ *
+ * :raises RuntimeError
+ */
+PymModule parseIR(LLVMContextRef ctx, LLVMMemoryBufferRef memBuf,
+                  bool nullTerminated = true);
+
+/**
+ * Read the file at `path` into a memory buffer, memory mapping it if `mmap` is
+ * true and LLVM considers it worthwhile.
+ *
+ * :raises RuntimeError
+ */
+LLVMMemoryBufferRef createMemoryBufferFromFile(const std::string &path, bool mmap);
+
+/**
+ * Parse the bitcode file at `path` into a module inside `ctx`. If `lazy` is true,
+ * function bodies are only loaded on materialization and the module keeps the
+ * file buffer.
+ *
+ * :raises RuntimeError
+ */
+PymModule parseBitcodeFile(LLVMContextRef ctx, const std::string &path, bool lazy);
+
+/**
+ * Create a memory buffer referring to the contents of a Python object supporting
+ * the buffer protocol, without copying. The Python object is kept alive (and its
+ * buffer export held) until the memory buffer is disposed.
+ *
+ * If `requiresNullTerminator` is true, the last byte of the object must be a
+ * null byte, which is then excluded from the buffer contents.
+ */
+LLVMMemoryBufferRef createMemoryBufferFromPyBuffer
+  (nanobind::handle obj, const std::string &bufferName, bool requiresNullTerminator);
+
+
+/**
+ * Parse every input (a path, or a MemoryBuffer or bytes-like object holding
+ * textual IR or bitcode) into a module in a new context of its own, on up to
+ * `maxWorkers` threads. Returns the modules in the order of the inputs, each
+ * keeping its context alive.
+ *
+ * :raises RuntimeError
+ */
+nanobind::list parseMany(nanobind::iterable inputs, std::optional<unsigned> maxWorkers);
+
+
+/**
+ * Split module `m` into `n` partitions with llvm::SplitModule. With
+ * `separateContexts`, every partition is moved into a new context of its own
+ * (parsed back from bitcode on up to `maxWorkers` threads), so that the
+ * partitions can be processed in parallel.
+ *
+ * :raises ValueError, RuntimeError
+ */
+nanobind::list splitModule(LLVMModuleRef m, unsigned n, bool preserveLocals,
+                           bool separateContexts, std::optional<unsigned> maxWorkers);
+
+
+/**
+ * Verify every function defined in module `m` on up to `maxWorkers` threads.
+ *
+ * Returns: the functions which are broken, along with the verifier messages
+ * about them, in module order
+ */
+std::vector<std::pair<LLVMValueRef, std::string>>
+verifyFunctions(LLVMModuleRef m, std::optional<unsigned> maxWorkers);
 
 
 #endif
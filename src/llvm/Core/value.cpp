@@ -9,8 +9,13 @@
 #include "../types_priv.h"
 #include "../utils_priv.h"
 #include "utils.h"
+#include "export.h"
+#include "sequence.h"
 #include <llvm-c/Analysis.h>
 #include <llvm/IR/Function.h>
+#include <llvm/IR/StructuralHash.h>
+#include <llvm/Support/Error.h>
+#include <stdexcept>
 
 namespace nb = nanobind;
 using namespace nb::literals;
@@ -116,6 +121,23 @@ void bindValueClasses(nb::module_ &m) {
                      return res;
                    },
                    "Obtain the given MDNode's operands.")
+      .def("operand_ids",  // c++ extension
+           [](PymMDNodeValue &self, PymValueTable &table) {
+             return exportMDNodeOperandIds(self.get(), table);
+           },
+           "table"_a,
+           "Return the id of every operand in table (a `ValueTable`) as a NumPy "
+           "array of uint32, without creating an operand object. Operands which "
+           "aren't in the table yet are numbered next. A missing operand has id "
+           "2**32 - 1. Requires numpy.\n\n"
+           ":raises RuntimeError: the IR may have been modified since the table "
+           "was built")
+      .def("operand_kinds",  // c++ extension
+           [](PymMDNodeValue &self) {
+             return exportMDNodeOperandKinds(self.get());
+           },
+           "Return the ValueKind value of every operand as a NumPy array, "
+           "-1 for a missing operand. Requires numpy.")
       .def_prop_ro("replace_operand_with",
                    [](PymMDNodeValue &self, unsigned index, PymMetadata &replacement) {
                      return LLVMReplaceMDNodeOperandWith
@@ -322,12 +344,14 @@ void bindValueClasses(nb::module_ &m) {
                    })
       .def("destory",
            [](PymGlobalIFunc &self) {
+             PymIREpoch::bump(LLVMGetTypeContext(LLVMTypeOf(self.get())));
              return LLVMEraseGlobalIFunc(self.get());
            },
            "Remove a global indirect function from its parent module and delete it.\n\n"
            "You shouldn't use it anymore after removal.")
       .def("remove_from_parent",
            [](PymGlobalIFunc &self) {
+             PymIREpoch::bump(LLVMGetTypeContext(LLVMTypeOf(self.get())));
              return LLVMRemoveGlobalIFunc(self.get());
            },
            "Remove a global indirect function from its parent module.\n\n"
@@ -471,12 +495,15 @@ void bindValueClasses(nb::module_ &m) {
            "  - The instruction has no name")
       .def("remove_from_parent",
            [](PymInstruction &self) {
+             PymIREpoch::bump(LLVMGetTypeContext(LLVMTypeOf(self.get())));
              return LLVMInstructionRemoveFromParent(self.get());
            },
            "The instruction specified is removed from its containing building"
            "block but is kept alive.")
       .def("destory",
            [](PymInstruction &self) {
+             PymIREpoch::bump(LLVMGetTypeContext(LLVMTypeOf(self.get())));
+             forgetInternedValue(self.get());
              return LLVMInstructionEraseFromParent(self.get());
            },
            "Remove and delete an instruction.\n\n"
@@ -484,6 +511,8 @@ void bindValueClasses(nb::module_ &m) {
            "block and then deleted.")
       .def("delete",
            [](PymInstruction &self) {
+             PymIREpoch::bump(LLVMGetTypeContext(LLVMTypeOf(self.get())));
+             forgetInternedValue(self.get());
              return LLVMDeleteInstruction(self.get());
            },
            "Delete an instruction.\n\n"
@@ -856,6 +885,7 @@ void bindValueClasses(nb::module_ &m) {
            })
       .def("__init__",
            [](PymGlobalVariable *g, PymModule &m, PymType &type, const char *name) {
+             PymIREpoch::bump(LLVMGetModuleContext(m.get()));
              new (g) PymGlobalVariable(LLVMAddGlobal(m.get(), type.get(), name));
            },
            "module"_a, "type"_a, "name"_a = "")
@@ -936,6 +966,8 @@ void bindValueClasses(nb::module_ &m) {
       // but python pass variable by value...
       .def("destory", 
            [](PymGlobalVariable &self) {
+             PymIREpoch::bump(LLVMGetTypeContext(LLVMTypeOf(self.get())));
+             forgetInternedValue(self.get());
              return LLVMDeleteGlobal(self.get());
            },
            "Delete this variable. You are not supposed to use this variable later.");
@@ -950,6 +982,7 @@ void bindValueClasses(nb::module_ &m) {
       .def("__init__",
            [](PymGlobalAlias *g, PymModule &self, PymType &valueType, unsigned addrSpace,
               PymValue aliasee, const char *name) {
+             PymIREpoch::bump(LLVMGetModuleContext(self.get()));
              new (g) PymGlobalAlias(LLVMAddAlias2
                                      (self.get(), valueType.get(), addrSpace,
                                       aliasee.get(), name));
@@ -988,6 +1021,7 @@ void bindValueClasses(nb::module_ &m) {
            })
       .def("__init__",
            [](PymFunction *f, PymModule &m, PymTypeFunction &functionTy, std::string &name) {
+             PymIREpoch::bump(LLVMGetModuleContext(m.get()));
              new (f) PymFunction(LLVMAddFunction(m.get(), name.c_str(), functionTy.get()));
            },
            "module"_a, "function_type"_a, "name"_a = "",
@@ -1016,13 +1050,10 @@ void bindValueClasses(nb::module_ &m) {
                    })
       .def_prop_ro("basic_blocks",
                    [](PymFunction &self) {
-                     unsigned num = LLVMCountBasicBlocks(self.get());
-                     std::vector<LLVMBasicBlockRef> BasicBlocks(num);
-                     LLVMGetBasicBlocks(self.get(), BasicBlocks.data());
-                     WRAP_VECTOR_FROM_DEST(PymBasicBlock, num,
-                                           res, BasicBlocks);
-                     return res;
-                   })
+                     return PymBasicBlockSequence(self.get());
+                   },
+                   "The basic blocks in the function, as a sequence supporting "
+                   "len, indexing and reversed.")
       .def_prop_ro("first_basic_block",
                    [](PymFunction &self) -> optional<PymBasicBlock> {
                      auto res =  LLVMGetFirstBasicBlock(self.get());
@@ -1109,21 +1140,155 @@ void bindValueClasses(nb::module_ &m) {
                    })
       .def("verify",
            [](PymFunction &self, LLVMVerifierFailureAction action) -> optional<std::string>{
-             char *outMsg;
-             auto res = LLVMVerifyFunction(self.get(), action) == 0;
-             if (!res) {
-               if (outMsg) {
-                 std::string errMsg(outMsg);
-                 LLVMDisposeMessage(outMsg);
-                 return errMsg;
-               }
-               return "";
+             bool res;
+             {
+               PymContextUse use(LLVMGetTypeContext(LLVMTypeOf(self.get())));
+               nb::gil_scoped_release release;
+               res = LLVMVerifyFunction(self.get(), action) == 0;
              }
+             // LLVMVerifyFunction reports no message, only prints it for
+             // the print action
+             if (!res)
+               return "";
              return std::nullopt;
            },
            "action"_a,
            "Verifies that a single function is valid, taking the specified action. Usefu"
            "for debugging.")
+      .def("structural_hash",  // c++ extension
+           [](PymFunction &self, bool detailed) {
+             uint64_t res;
+             {
+               PymContextUse use(LLVMGetTypeContext(LLVMTypeOf(self.get())));
+               nb::gil_scoped_release release;
+               res = llvm::StructuralHash(*llvm::unwrap<llvm::Function>(self.get()),
+                                          detailed);
+             }
+             return res;
+           },
+           "detailed"_a = false,
+           "Compute a hash of the structure of the function, i.e. its signature, "
+           "basic blocks and instruction opcodes, ignoring names. Structurally "
+           "identical functions (e.g. in different modules or contexts) have the "
+           "same hash.\n\n"
+           "Args:\n"
+           "\tdetailed: also hash the types of instructions and their operands, "
+           "including the values of constants, so that fewer distinct functions "
+           "collide.\n\n"
+           "Note the body of a lazily loaded function needs to be materialized "
+           "first.")
+      .def_prop_ro("is_materializable",  // c++ extension
+                   [](PymFunction &self) {
+                     using namespace llvm;
+                     return unwrap<Function>(self.get())->isMaterializable();
+                   },
+                   "Whether the body of this function hasn't been loaded yet, i.e. "
+                   "it belongs to a lazily loaded module (e.g. "
+                   "Context.get_bitcode_module) and can be materialized.")
+      .def("materialize",  // c++ extension
+           [](PymFunction &self) {
+             using namespace llvm;
+             PymIREpoch::bump(LLVMGetTypeContext(LLVMTypeOf(self.get())));
+             Error err = [&]() {
+               PymContextUse use(LLVMGetTypeContext(LLVMTypeOf(self.get())));
+               nb::gil_scoped_release release;
+               return unwrap<Function>(self.get())->materialize();
+             }();
+             if (err)
+               throw std::runtime_error(toString(std::move(err)));
+           },
+           "Load the body of this function if it is materializable. Does nothing "
+           "otherwise.\n\n"
+           ":raises RuntimeError")
+      .def("export_instructions",  // c++ extension
+           [](PymFunction &self) {
+             return exportInstructions(self.get());
+           },
+           "Walk all the instructions of this function in C++ and return them as "
+           "a dict of NumPy arrays (one row per instruction, in program order), "
+           "without creating a Python object per instruction. Requires numpy.\n\n"
+           "Keys:\n"
+           "  - opcode: Opcode value of the instruction\n"
+           "  - block: index of the containing basic block\n"
+           "  - type: index of the result type into `types`\n"
+           "  - num_operands: number of operands\n"
+           "  - operand_offsets, operand_ids: operands in CSR form, i.e. the "
+           "operands of instruction i are "
+           "operand_ids[operand_offsets[i]:operand_offsets[i+1]]\n"
+           "  - debug_line: line of the debug location, 0 if there is none\n"
+           "  - value_kind: ValueKind value of every value id\n"
+           "  - types: list of type strings\n"
+           "  - num_instructions, num_arguments\n"
+           "  - value_table: the `ValueTable` mapping value ids back to values\n\n"
+           "Value ids: instruction i has id i, argument j has id "
+           "num_instructions + j, other values (constants, globals, basic blocks, "
+           "metadata) are numbered afterwards in first-seen order.")
+      .def("def_use_graph",  // c++ extension
+           [](PymFunction &self) {
+             return exportDefUseGraph(self.get());
+           },
+           "Build the def-use graph of the values used by the instructions of this "
+           "function in C++ and return it as a dict of NumPy arrays in CSR form. "
+           "Constants with operands (constant expressions, aggregates, ...) are "
+           "followed as well, so e.g. a global used through a getelementptr "
+           "constant expression has that expression as its user, which in turn "
+           "is used by the instruction. Each such constant appears once. Global "
+           "values are leaves. Requires numpy.\n\n"
+           "Keys:\n"
+           "  - def_use_offsets, def_use_targets: the users of value i are "
+           "def_use_targets[def_use_offsets[i]:def_use_offsets[i+1]]\n"
+           "  - use_def_offsets, use_def_targets: the operands of value i, in "
+           "operand order\n"
+           "  - value_kind: ValueKind value of every value id\n"
+           "  - num_instructions, num_arguments\n"
+           "  - value_table: the `ValueTable` mapping value ids back to values\n\n"
+           "Value ids are the same as the ones of `export_instructions`.")
+      .def("cfg",  // c++ extension
+           [](PymFunction &self) {
+             return exportCFG(self.get());
+           },
+           "Return the control flow graph of this function as a dict of NumPy "
+           "arrays in CSR form, over basic block indices (in `basic_blocks` order)."
+           " Requires numpy.\n\n"
+           "Keys:\n"
+           "  - successor_offsets, successor_targets: the successors of block i are "
+           "successor_targets[successor_offsets[i]:successor_offsets[i+1]]\n"
+           "  - predecessor_offsets, predecessor_targets\n"
+           "  - num_blocks")
+      .def("dominator_tree",  // c++ extension
+           [](PymFunction &self) {
+             return exportDominatorTree(self.get(), false);
+           },
+           "Compute the dominator tree of this function. Returns a NumPy array "
+           "holding the index of the immediate dominator of every basic block, "
+           "-1 for the entry block and unreachable blocks. Requires numpy.\n\n"
+           ":raises ValueError: if the function is a declaration")
+      .def("post_dominator_tree",  // c++ extension
+           [](PymFunction &self) {
+             return exportDominatorTree(self.get(), true);
+           },
+           "Compute the post-dominator tree of this function. Returns a NumPy "
+           "array holding the index of the immediate post-dominator of every "
+           "basic block, -1 if there is none (e.g. for exit blocks). "
+           "Requires numpy.\n\n"
+           ":raises ValueError: if the function is a declaration")
+      .def("loop_info",  // c++ extension
+           [](PymFunction &self) {
+             return exportLoopInfo(self.get());
+           },
+           "Find the natural loops of this function. Returns a dict of NumPy "
+           "arrays, loops are numbered in preorder (outer loops first). "
+           "Requires numpy.\n\n"
+           "Keys:\n"
+           "  - header: index of the header block of every loop\n"
+           "  - depth: nesting depth of every loop, 1 for outermost loops\n"
+           "  - parent: index of the enclosing loop, -1 for outermost loops\n"
+           "  - block_offsets, blocks: the blocks of loop i (including the "
+           "blocks of nested loops) are blocks[block_offsets[i]:block_offsets[i+1]]"
+           "\n"
+           "  - block_loop: for every basic block, the index of the innermost "
+           "loop containing it, -1 if none\n\n"
+           ":raises ValueError: if the function is a declaration")
       .def("get_arg",
            [](PymFunction &self, unsigned index) {
              return PymArgument(LLVMGetParam(self.get(), index));
@@ -1133,6 +1298,8 @@ void bindValueClasses(nb::module_ &m) {
            "Parameters are indexed from 0.")
       .def("destory", // TODO test
            [](PymFunction &self) {
+             PymIREpoch::bump(LLVMGetTypeContext(LLVMTypeOf(self.get())));
+             forgetInternedValue(self.get());
              return LLVMDeleteFunction(self.get());
            },
            "Remove a function from its containing module and deletes it.\n\n"
@@ -1144,12 +1311,14 @@ void bindValueClasses(nb::module_ &m) {
            "index"_a, "attr"_a)
       .def("append_existing_basic_block",
            [](PymFunction &self, PymBasicBlock bb) {
+             PymIREpoch::bump(LLVMGetTypeContext(LLVMTypeOf(self.get())));
              return LLVMAppendExistingBasicBlock(self.get(), bb.get());
            },
            "basic_block"_a,
            "Append the given basic block to the basic block list of the given function.")
       .def("append_basic_block",
            [](PymFunction &self, const char *name) {
+             PymIREpoch::bump(LLVMGetTypeContext(LLVMTypeOf(self.get())));
              return PymBasicBlock(LLVMAppendBasicBlock(self.get(), name));
            },
            "name"_a = "",
@@ -1256,6 +1425,22 @@ void bindValueClasses(nb::module_ &m) {
                      }
                      return pymOps;
                    })
+      .def("operand_ids",  // c++ extension
+           [](PymUser &self, PymValueTable &table) {
+             return exportUserOperandIds(self.get(), table);
+           },
+           "table"_a,
+           "Return the id of every operand in table (a `ValueTable`) as a NumPy "
+           "array of uint32, without creating an operand object. Operands which "
+           "aren't in the table yet are numbered next. Requires numpy.\n\n"
+           ":raises RuntimeError: the IR may have been modified since the table "
+           "was built")
+      .def("operand_kinds",  // c++ extension
+           [](PymUser &self) {
+             return exportUserOperandKinds(self.get());
+           },
+           "Return the ValueKind value of every operand as a NumPy array. "
+           "Requires numpy.")
       .def("get_operand",
            [](PymUser &u, unsigned index) {
              return PymValueAuto(LLVMGetOperand(u.get(), index));
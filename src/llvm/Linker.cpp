@@ -16,12 +16,21 @@ void populateLinker(nanobind::module_ &m) {
   // TODO customize (if error, throw an runtime error containing the reason. Just
   // like what llvmlite does)
   m.def("link_module",
-        [](PymModule dest, PymModule src) {
-          return LLVMLinkModules2(dest.get(), src.get()) != 0;
+        [](PymModule &dest, PymModule &src) {
+          src.ensureTransferable();
+          PymIREpoch::bump(LLVMGetModuleContext(dest.get()));
+          bool failed;
+          {
+            PymContextUse use(LLVMGetModuleContext(dest.get()));
+            nb::gil_scoped_release release;
+            failed = LLVMLinkModules2(dest.get(), src.get()) != 0;
+          }
+          src.reset(); // destroyed by LLVM in any case
+          return failed;
         },
         "dest"_a, "src"_a,
         "Links the source module into the destination module. The source module is"
-        "destroyed.\n"
+        "destroyed, so it cannot be used afterwards.\n"
         "The return value is true if an error occurred, false otherwise.\n"
         "Use the diagnostic handler to get any diagnostic message.");
 }
@@ -71,8 +71,12 @@ void populateObject(nb::module_ &m) {
   BinaryClass
       .def("__init__",
            [](PymBinary *b, PymMemoryBuffer &memBuf, PymContext &cxt) {
-             char *errorMessage;
-             auto res = LLVMCreateBinary(memBuf.get(), cxt.get(), &errorMessage);
+             char *errorMessage = nullptr;
+             LLVMBinaryRef res;
+             {
+               nb::gil_scoped_release release;
+               res = LLVMCreateBinary(memBuf.get(), cxt.get(), &errorMessage);
+             }
              auto success = res != NULL;
              THROW_ERORR_DISPOSE_MESSAGE_IF_FALSE(success, errorMessage);
              new (b) PymBinary(res);
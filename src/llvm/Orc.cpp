@@ -0,0 +1,236 @@
+#include "Orc.h"
+
+#include <nanobind/nanobind.h>
+#include <nanobind/stl/map.h>
+#include <nanobind/stl/string.h>
+#include <llvm-c/Error.h>
+#include <llvm-c/LLJIT.h>
+#include <llvm-c/Orc.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/Error.h>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "types_priv.h"
+#include "utils_priv.h"
+
+namespace nb = nanobind;
+using namespace nb::literals;
+
+
+/*
+ * Check that `module` can be handed over to a JIT together with `context`
+ */
+static void checkJITModule(PymModule &module, PymThreadSafeContext &context) {
+  module.ensureTransferable();
+  if (LLVMGetModuleContext(module.get()) !=
+        LLVMOrcThreadSafeContextGetContext(context.get()))
+    throw nb::value_error("The module doesn't belong to the context of the given "
+                          "ThreadSafeContext.");
+}
+
+void populateOrc(nb::module_ &m) {
+  auto ThreadSafeContextClass =
+    nb::class_<PymThreadSafeContext,
+               PymLLVMObject<PymThreadSafeContext, LLVMOrcThreadSafeContextRef>>
+      (m, "ThreadSafeContext", "ThreadSafeContext");
+
+  auto LLJITClass =
+    nb::class_<PymLLJIT, PymLLVMObject<PymLLJIT, LLVMOrcLLJITRef>>
+      (m, "LLJIT", "LLJIT");
+
+  auto LLLazyJITClass =
+    nb::class_<PymLLLazyJIT, PymLLJIT>(m, "LLLazyJIT", "LLLazyJIT");
+
+  ThreadSafeContextClass
+      .def("__repr__",
+           [](PymThreadSafeContext &self) {
+             return "<ThreadSafeContext>";
+           })
+      .def("__init__",
+           [](PymThreadSafeContext *tsc) {
+             new (tsc) PymThreadSafeContext(LLVMOrcCreateNewThreadSafeContext());
+           },
+           "Create a ThreadSafeContext containing a new LLVMContext.")
+      .def_prop_ro("context",
+                   [](PymThreadSafeContext &self) {
+                     return PymContext(LLVMOrcThreadSafeContextGetContext
+                                         (self.get()), true);
+                   },
+                   nb::keep_alive<0, 1>(),
+                   "The LLVMContext wrapped by this ThreadSafeContext. Create modules "
+                   "to be added to a LLJIT inside it.\n\n"
+                   "The context is owned by the ThreadSafeContext (and the modules "
+                   "added to JITs). The returned Context and the modules created in "
+                   "it keep this ThreadSafeContext alive.");
+
+  LLJITClass
+      .def("__repr__",
+           [](PymLLJIT &self) {
+             return "<LLJIT>";
+           })
+      .def("__init__",
+           [](PymLLJIT *jit) {
+             LLVMOrcLLJITRef J;
+             // a null builder means a default-constructed one
+             auto err = LLVMOrcCreateLLJIT(&J, nullptr);
+             THROW_IF_ERROR_REF(err);
+             new (jit) PymLLJIT(J);
+           },
+           "Create an LLJIT instance targeting the host. The native target and asm "
+           "printer need to be initialized beforehand (see "
+           "target.init_native_target and target.init_native_asm_printer).\n\n"
+           ":raises RuntimeError")
+      .def_prop_ro("triple",
+                   [](PymLLJIT &self) {
+                     return LLVMOrcLLJITGetTripleString(self.get());
+                   },
+                   "The target triple for this LLJIT instance.")
+      .def_prop_ro("data_layout",
+                   [](PymLLJIT &self) {
+                     return LLVMOrcLLJITGetDataLayoutStr(self.get());
+                   },
+                   "The data layout string for this LLJIT instance. Modules added "
+                   "to the JIT should use it.")
+      .def_prop_ro("global_prefix",
+                   [](PymLLJIT &self) {
+                     return LLVMOrcLLJITGetGlobalPrefix(self.get());
+                   },
+                   "The global prefix character according to the LLJIT's data "
+                   "layout.")
+      .def("add_module",
+           [](PymLLJIT &self, PymModule &module, PymThreadSafeContext &context) {
+             checkJITModule(module, context);
+             auto tsm = LLVMOrcCreateNewThreadSafeModule(module.get(), context.get());
+             module.reset();
+             LLVMErrorRef err;
+             {
+               nb::gil_scoped_release release;
+               err = LLVMOrcLLJITAddLLVMIRModule
+                       (self.get(), LLVMOrcLLJITGetMainJITDylib(self.get()), tsm);
+             }
+             THROW_IF_ERROR_REF(err);
+           },
+           "module"_a, "context"_a,
+           "Add an IR module to the main JITDylib. The module is wrapped into a "
+           "thread-safe module together with context, which must be the "
+           "ThreadSafeContext the module was created in.\n\n"
+           "The ownership of module is transferred to the JIT (like "
+           "linker.link_module), so it cannot be used afterwards.\n\n"
+           ":raises RuntimeError")
+      .def("add_object_file",
+           [](PymLLJIT &self, PymMemoryBuffer &memBuf) {
+             memBuf.ensureTransferable();
+             LLVMErrorRef err;
+             {
+               nb::gil_scoped_release release;
+               err = LLVMOrcLLJITAddObjectFile
+                       (self.get(), LLVMOrcLLJITGetMainJITDylib(self.get()),
+                        memBuf.get());
+             }
+             memBuf.reset();
+             THROW_IF_ERROR_REF(err);
+           },
+           "mem_buf"_a,
+           "Add a buffer representing an object file to the main JITDylib. The "
+           "ownership of the buffer is transferred to the JIT.\n\n"
+           ":raises RuntimeError")
+      .def("lookup",
+           [](PymLLJIT &self, const std::string &name) {
+             LLVMOrcExecutorAddress addr;
+             LLVMErrorRef err;
+             // may compile modules of any context
+             PymIREpoch::bumpAll();
+             {
+               // may trigger compilation
+               nb::gil_scoped_release release;
+               err = LLVMOrcLLJITLookup(self.get(), &addr, name.c_str());
+             }
+             THROW_IF_ERROR_REF(err);
+             return static_cast<uint64_t>(addr);
+           },
+           "name"_a,
+           "Look up the given symbol in the main JITDylib, compiling it if "
+           "necessary, and return its address. The name is mangled automatically.\n"
+           "The address can be turned into a callable with ctypes, e.g. "
+           "``ctypes.CFUNCTYPE(ctypes.c_int)(addr)``.\n\n"
+           ":raises RuntimeError: the symbol cannot be found or compiled.")
+      .def("define_absolute_symbols",
+           [](PymLLJIT &self, const std::map<std::string, uint64_t> &symbols) {
+             std::vector<LLVMOrcCSymbolMapPair> pairs;
+             pairs.reserve(symbols.size());
+             for (auto &[name, addr] : symbols) {
+               LLVMJITSymbolFlags flags = {
+                 LLVMJITSymbolGenericFlagsExported | LLVMJITSymbolGenericFlagsCallable,
+                 0
+               };
+               pairs.push_back({LLVMOrcLLJITMangleAndIntern(self.get(), name.c_str()),
+                                {addr, flags}});
+             }
+             auto mu = LLVMOrcAbsoluteSymbols(pairs.data(), pairs.size());
+             auto err = LLVMOrcJITDylibDefine
+                          (LLVMOrcLLJITGetMainJITDylib(self.get()), mu);
+             if (err)
+               LLVMOrcDisposeMaterializationUnit(mu);
+             THROW_IF_ERROR_REF(err);
+           },
+           "symbols"_a,
+           "Define symbols with fixed addresses (e.g. of functions created with "
+           "ctypes) in the main JITDylib, so that jitted code can refer to them. "
+           "symbols maps unmangled names to addresses.\n\n"
+           ":raises RuntimeError: a symbol is already defined.");
+
+  LLLazyJITClass
+      .def("__repr__",
+           [](PymLLLazyJIT &self) {
+             return "<LLLazyJIT>";
+           })
+      .def("__init__",  // c++ extension
+           [](PymLLLazyJIT *jit, unsigned numCompileThreads) {
+             using namespace llvm::orc;
+             auto res = LLLazyJITBuilder()
+                          .setNumCompileThreads(numCompileThreads)
+                          .create();
+             if (!res)
+               throw std::runtime_error(llvm::toString(res.takeError()));
+             // the C API functions operate on the LLJIT base
+             LLJIT *J = res->release();
+             new (jit) PymLLLazyJIT(reinterpret_cast<LLVMOrcLLJITRef>(J));
+           },
+           "num_compile_threads"_a = 0,
+           "Create a JIT which can compile the functions of modules added through "
+           "add_lazy_module on their first call. With num_compile_threads > 0, "
+           "compilation runs on a pool of that many background threads, otherwise "
+           "on the thread which triggers it.\n\n"
+           "The native target and asm printer need to be initialized beforehand.\n\n"
+           ":raises RuntimeError")
+      .def("add_lazy_module",  // c++ extension
+           [](PymLLLazyJIT &self, PymModule &module, PymThreadSafeContext &context) {
+             using namespace llvm;
+             using namespace llvm::orc;
+             checkJITModule(module, context);
+             ThreadSafeModule tsm
+               (std::unique_ptr<Module>(unwrap(module.get())),
+                *reinterpret_cast<ThreadSafeContext *>(context.get()));
+             module.reset();
+             Error err = [&]() {
+               nb::gil_scoped_release release;
+               auto *J = static_cast<LLLazyJIT *>
+                           (reinterpret_cast<LLJIT *>(self.get()));
+               return J->addLazyIRModule(std::move(tsm));
+             }();
+             if (err)
+               throw std::runtime_error(toString(std::move(err)));
+           },
+           "module"_a, "context"_a,
+           "Add an IR module whose functions are only compiled when first called "
+           "(or looked up). Calls go through stubs which trigger the compilation.\n\n"
+           "The ownership of module is transferred to the JIT, so it cannot be used "
+           "afterwards. Don't use context while functions of the module may be "
+           "compiled by background threads.\n\n"
+           ":raises RuntimeError");
+}
@@ -0,0 +1,8 @@
+#ifndef LLVMPYM_ORC_H
+#define LLVMPYM_ORC_H
+
+#include <nanobind/nanobind.h>
+
+void populateOrc(nanobind::module_ &m);
+
+#endif
@@ -0,0 +1,298 @@
+#include "PassBuilder.h"
+
+#include <nanobind/nanobind.h>
+#include <nanobind/stl/string.h>
+#include <llvm-c/Error.h>
+#include <llvm-c/Transforms/PassBuilder.h>
+#include <llvm/ADT/Any.h>
+#include <llvm/Analysis/CGSCCPassManager.h>
+#include <llvm/Analysis/LazyCallGraph.h>
+#include <llvm/Analysis/LoopInfo.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/PassInstrumentation.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Passes/StandardInstrumentations.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/Timer.h>
+#include <llvm/Target/TargetMachine.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "types_priv.h"
+#include "utils_priv.h"
+
+namespace nb = nanobind;
+using namespace nb::literals;
+
+
+struct PassTiming {
+  std::string pass;
+  std::string irKind;
+  std::string irName;
+  double wallTime = 0;
+  double userTime = 0;
+  bool changed = false;
+};
+
+static void describeIRUnit(llvm::Any IR, PassTiming &timing) {
+  using namespace llvm;
+  if (const auto *M = any_cast<const Module *>(&IR)) {
+    timing.irKind = "module";
+    timing.irName = (*M)->getModuleIdentifier();
+  } else if (const auto *F = any_cast<const Function *>(&IR)) {
+    timing.irKind = "function";
+    timing.irName = (*F)->getName().str();
+  } else if (const auto *C = any_cast<const LazyCallGraph::SCC *>(&IR)) {
+    timing.irKind = "cgscc";
+    timing.irName = (*C)->getName();
+  } else if (const auto *L = any_cast<const Loop *>(&IR)) {
+    timing.irKind = "loop";
+    timing.irName = (*L)->getName().str();
+  }
+}
+
+/*
+ * Same as LLVMRunPasses, additionally recording the time spent in every pass.
+ *
+ * Pass managers and adaptors only forward to the passes they contain, so they
+ * are not recorded (like `opt -time-passes` does).
+ */
+static std::vector<PassTiming>
+runPassesWithTimings(LLVMModuleRef M, const std::string &passes,
+                     LLVMTargetMachineRef TM,
+                     const PymPassBuilderOptions::Settings &settings) {
+  using namespace llvm;
+  Module *mod = unwrap(M);
+  auto *machine = reinterpret_cast<TargetMachine *>(TM);
+
+  PipelineTuningOptions PTO;
+  if (settings.loopInterleaving) PTO.LoopInterleaving = *settings.loopInterleaving;
+  if (settings.loopVectorization) PTO.LoopVectorization = *settings.loopVectorization;
+  if (settings.slpVectorization) PTO.SLPVectorization = *settings.slpVectorization;
+  if (settings.loopUnrolling) PTO.LoopUnrolling = *settings.loopUnrolling;
+  if (settings.forgetAllSCEVInLoopUnroll)
+    PTO.ForgetAllSCEVInLoopUnroll = *settings.forgetAllSCEVInLoopUnroll;
+  if (settings.licmMssaOptCap) PTO.LicmMssaOptCap = *settings.licmMssaOptCap;
+  if (settings.licmMssaNoAccForPromotionCap)
+    PTO.LicmMssaNoAccForPromotionCap = *settings.licmMssaNoAccForPromotionCap;
+  if (settings.callGraphProfile) PTO.CallGraphProfile = *settings.callGraphProfile;
+  if (settings.mergeFunctions) PTO.MergeFunctions = *settings.mergeFunctions;
+
+  std::vector<PassTiming> timings;
+  // index into `timings` and start time of the passes currently running
+  std::vector<std::pair<size_t, TimeRecord>> running;
+  const std::vector<StringRef> specialPasses = {
+    "PassManager", "PassAdaptor", "AnalysisManagerProxy",
+    "DevirtSCCRepeatedPass", "ModuleInlinerWrapperPass"
+  };
+
+  auto finish = [&](StringRef passID, bool changed) {
+    if (isSpecialPass(passID, specialPasses) || running.empty())
+      return;
+    auto end = TimeRecord::getCurrentTime(false);
+    auto [index, start] = running.back();
+    running.pop_back();
+    auto &timing = timings[index];
+    timing.wallTime = end.getWallTime() - start.getWallTime();
+    timing.userTime = end.getUserTime() - start.getUserTime();
+    timing.changed = changed;
+  };
+
+  PassInstrumentationCallbacks PIC;
+  PIC.registerBeforeNonSkippedPassCallback([&](StringRef passID, Any IR) {
+    if (isSpecialPass(passID, specialPasses))
+      return;
+    PassTiming timing;
+    timing.pass = passID.str();
+    describeIRUnit(IR, timing);
+    timings.push_back(std::move(timing));
+    running.emplace_back(timings.size() - 1, TimeRecord::getCurrentTime(true));
+  });
+  PIC.registerAfterPassCallback(
+    [&](StringRef passID, Any IR, const PreservedAnalyses &PA) {
+      finish(passID, !PA.areAllPreserved());
+    });
+  PIC.registerAfterPassInvalidatedCallback(
+    [&](StringRef passID, const PreservedAnalyses &PA) {
+      finish(passID, true);
+    });
+
+  PassBuilder PB(machine, PTO, std::nullopt, &PIC);
+
+  LoopAnalysisManager LAM;
+  FunctionAnalysisManager FAM;
+  CGSCCAnalysisManager CGAM;
+  ModuleAnalysisManager MAM;
+  PB.registerLoopAnalyses(LAM);
+  PB.registerFunctionAnalyses(FAM);
+  PB.registerCGSCCAnalyses(CGAM);
+  PB.registerModuleAnalyses(MAM);
+  PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+
+  StandardInstrumentations SI(mod->getContext(), settings.debugLogging,
+                              settings.verifyEach);
+  SI.registerCallbacks(PIC, &MAM);
+  ModulePassManager MPM;
+  if (settings.verifyEach)
+    MPM.addPass(VerifierPass());
+  if (auto err = PB.parsePassPipeline(MPM, passes))
+    throw std::runtime_error(toString(std::move(err)));
+
+  MPM.run(*mod, MAM);
+  return timings;
+}
+
+void populatePassBuilder(nb::module_ &m) {
+  auto PassBuilderOptionsClass =
+    nb::class_<PymPassBuilderOptions,
+               PymLLVMObject<PymPassBuilderOptions, LLVMPassBuilderOptionsRef>>
+      (m, "PassBuilderOptions", "PassBuilderOptions");
+
+  PassBuilderOptionsClass
+      .def("__repr__",
+           [](PymPassBuilderOptions &self) {
+             return "<PassBuilderOptions>";
+           })
+      .def("__init__",
+           [](PymPassBuilderOptions *pbo) {
+             new (pbo) PymPassBuilderOptions(LLVMCreatePassBuilderOptions());
+           },
+           "Create a new set of options for a PassBuilder.")
+      .def("set_verify_each",
+           [](PymPassBuilderOptions &self, bool verifyEach) {
+             self.settings.verifyEach = verifyEach;
+             return LLVMPassBuilderOptionsSetVerifyEach(self.get(), verifyEach);
+           },
+           "verify_each"_a,
+           "Toggle adding the VerifierPass for the PassBuilder, ensuring all functions "
+           "inside the module is valid.")
+      .def("set_debug_logging",
+           [](PymPassBuilderOptions &self, bool debugLogging) {
+             self.settings.debugLogging = debugLogging;
+             return LLVMPassBuilderOptionsSetDebugLogging(self.get(), debugLogging);
+           },
+           "debug_logging"_a,
+           "Toggle debug logging when running the PassBuilder.")
+      .def("set_loop_interleaving",
+           [](PymPassBuilderOptions &self, bool loopInterleaving) {
+             self.settings.loopInterleaving = loopInterleaving;
+             return LLVMPassBuilderOptionsSetLoopInterleaving
+                      (self.get(), loopInterleaving);
+           },
+           "loop_interleaving"_a)
+      .def("set_loop_vectorization",
+           [](PymPassBuilderOptions &self, bool loopVectorization) {
+             self.settings.loopVectorization = loopVectorization;
+             return LLVMPassBuilderOptionsSetLoopVectorization
+                      (self.get(), loopVectorization);
+           },
+           "loop_vectorization"_a)
+      .def("set_slp_vectorization",
+           [](PymPassBuilderOptions &self, bool slpVectorization) {
+             self.settings.slpVectorization = slpVectorization;
+             return LLVMPassBuilderOptionsSetSLPVectorization
+                      (self.get(), slpVectorization);
+           },
+           "slp_vectorization"_a)
+      .def("set_loop_unrolling",
+           [](PymPassBuilderOptions &self, bool loopUnrolling) {
+             self.settings.loopUnrolling = loopUnrolling;
+             return LLVMPassBuilderOptionsSetLoopUnrolling(self.get(), loopUnrolling);
+           },
+           "loop_unrolling"_a)
+      .def("set_forget_all_scev_in_loop_unroll",
+           [](PymPassBuilderOptions &self, bool forgetAllSCEVInLoopUnroll) {
+             self.settings.forgetAllSCEVInLoopUnroll = forgetAllSCEVInLoopUnroll;
+             return LLVMPassBuilderOptionsSetForgetAllSCEVInLoopUnroll
+                      (self.get(), forgetAllSCEVInLoopUnroll);
+           },
+           "forget_all_scev_in_loop_unroll"_a)
+      .def("set_licm_mssa_opt_cap",
+           [](PymPassBuilderOptions &self, unsigned licmMssaOptCap) {
+             self.settings.licmMssaOptCap = licmMssaOptCap;
+             return LLVMPassBuilderOptionsSetLicmMssaOptCap(self.get(), licmMssaOptCap);
+           },
+           "licm_mssa_opt_cap"_a)
+      .def("set_licm_mssa_no_acc_for_promotion_cap",
+           [](PymPassBuilderOptions &self, unsigned licmMssaNoAccForPromotionCap) {
+             self.settings.licmMssaNoAccForPromotionCap = licmMssaNoAccForPromotionCap;
+             return LLVMPassBuilderOptionsSetLicmMssaNoAccForPromotionCap
+                      (self.get(), licmMssaNoAccForPromotionCap);
+           },
+           "licm_mssa_no_acc_for_promotion_cap"_a)
+      .def("set_call_graph_profile",
+           [](PymPassBuilderOptions &self, bool callGraphProfile) {
+             self.settings.callGraphProfile = callGraphProfile;
+             return LLVMPassBuilderOptionsSetCallGraphProfile
+                      (self.get(), callGraphProfile);
+           },
+           "call_graph_profile"_a)
+      .def("set_merge_functions",
+           [](PymPassBuilderOptions &self, bool mergeFunctions) {
+             self.settings.mergeFunctions = mergeFunctions;
+             return LLVMPassBuilderOptionsSetMergeFunctions(self.get(), mergeFunctions);
+           },
+           "merge_functions"_a);
+
+  m.def("run_passes",
+        [](PymModule &module, const std::string &passes,
+           PymTargetMachine *tm, PymPassBuilderOptions *options,
+           bool report) -> nb::object {
+          PymIREpoch::bump(LLVMGetModuleContext(module.get()));
+          if (report) {
+            std::vector<PassTiming> timings;
+            {
+              PymContextUse use(LLVMGetModuleContext(module.get()));
+              nb::gil_scoped_release release;
+              timings = runPassesWithTimings
+                          (module.get(), passes, tm ? tm->get() : nullptr,
+                           options ? options->settings
+                                   : PymPassBuilderOptions::Settings());
+            }
+            nb::list res;
+            for (auto &timing : timings) {
+              nb::dict entry;
+              entry["pass"] = timing.pass;
+              entry["ir_kind"] = timing.irKind;
+              entry["ir_name"] = timing.irName;
+              entry["wall_time"] = timing.wallTime;
+              entry["user_time"] = timing.userTime;
+              entry["changed"] = timing.changed;
+              res.append(entry);
+            }
+            return res;
+          }
+
+          LLVMErrorRef err;
+          {
+            PymContextUse use(LLVMGetModuleContext(module.get()));
+            nb::gil_scoped_release release;
+            LLVMPassBuilderOptionsRef opts =
+              options ? options->get() : LLVMCreatePassBuilderOptions();
+            err = LLVMRunPasses(module.get(), passes.c_str(),
+                                tm ? tm->get() : nullptr, opts);
+            if (!options)
+              LLVMDisposePassBuilderOptions(opts);
+          }
+          THROW_IF_ERROR_REF(err);
+          return nb::none();
+        },
+        "module"_a, "passes"_a, "target_machine"_a.none() = nb::none(),
+        "options"_a.none() = nb::none(), "report"_a = false,
+        "Construct and run a set of passes over a module.\n\n"
+        "This function takes a string with the passes that should be used. The "
+        "format of this string is the same as opt's -passes argument for the new "
+        "pass manager, e.g. \"default<O3>\" or \"function(instcombine,gvn)\". "
+        "Individual passes may be specified, separated by commas. Full pipelines "
+        "may also be invoked using `default<O3>` and friends.\n\n"
+        "If report is true, a list with one dict per executed pass is returned, in "
+        "the order the passes started. Each dict has the keys ``pass``, ``ir_kind`` "
+        "(module, cgscc, function or loop), ``ir_name``, ``wall_time`` and "
+        "``user_time`` (seconds, user time is process-wide) and ``changed`` "
+        "(whether the pass did not preserve all analyses). Pass managers and "
+        "adaptors are not listed themselves. Otherwise None is returned.\n\n"
+        "Raises:\n"
+        "\tRuntimeError: the pipeline cannot be parsed.");
+}
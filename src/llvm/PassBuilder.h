@@ -0,0 +1,8 @@
+#ifndef LLVMPYM_PASSBUILDER_H
+#define LLVMPYM_PASSBUILDER_H
+
+#include <nanobind/nanobind.h>
+
+void populatePassBuilder(nanobind::module_ &m);
+
+#endif
@@ -2,16 +2,156 @@
 
 #include <nanobind/nanobind.h>
 #include <nanobind/stl/optional.h>
+#include <nanobind/stl/vector.h>
 #include <llvm-c/Core.h>
 #include <llvm-c/TargetMachine.h>
+#include <llvm/MC/TargetRegistry.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Target/TargetMachine.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <optional>
 #include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #include "types_priv.h"
 #include "utils_priv.h"
+#include "TargetMachine/CompilationCache.h"
 
 namespace nb = nanobind;
 using namespace nb::literals;
 
+template <typename T>
+using optional = std::optional<T>;
+
+
+/**
+ * Create a new target machine with the same triple, cpu, features, options and
+ * code generation settings as `T`. Returns null if the target fails to create
+ * one.
+ */
+static LLVMTargetMachineRef cloneTargetMachine(LLVMTargetMachineRef T) {
+  auto *TM = reinterpret_cast<llvm::TargetMachine *>(T);
+  auto *clone = TM->getTarget().createTargetMachine
+                  (TM->getTargetTriple().str(), TM->getTargetCPU(),
+                   TM->getTargetFeatureString(), TM->Options,
+                   TM->getRelocationModel(), TM->getCodeModel(),
+                   TM->getOptLevel());
+  return reinterpret_cast<LLVMTargetMachineRef>(clone);
+}
+
+/**
+ * Emit every module to a memory buffer on up to `maxWorkers` threads.
+ *
+ * A target machine must not be shared between threads, so each worker
+ * generates code with its own clone of `tm`. Modules living in the same
+ * context are emitted one after another by the same worker.
+ */
+static std::vector<PymMemoryBuffer>
+emitMany(PymTargetMachine &tm, const std::vector<PymModule> &modules,
+         LLVMCodeGenFileType codegen, optional<unsigned> maxWorkers) {
+  size_t num = modules.size();
+  std::vector<LLVMModuleRef> mods;
+  mods.reserve(num);
+  for (auto &m : modules)
+    mods.push_back(m.get());
+
+  std::vector<std::vector<size_t>> groups;
+  std::unordered_map<LLVMContextRef, size_t> groupIndex;
+  for (size_t i = 0; i < num; i++) {
+    auto [it, inserted] = groupIndex.try_emplace(LLVMGetModuleContext(mods[i]),
+                                                 groups.size());
+    if (inserted)
+      groups.emplace_back();
+    groups[it->second].push_back(i);
+  }
+
+  size_t workers = maxWorkers.value_or(std::thread::hardware_concurrency());
+  workers = std::clamp<size_t>(workers, 1, std::max<size_t>(groups.size(), 1));
+
+  std::vector<LLVMMemoryBufferRef> bufs(num, nullptr);
+  std::atomic<size_t> nextGroup{0};
+  std::atomic<bool> failed{false};
+  std::mutex errorMutex;
+  size_t errorIndex = num;
+  std::string errorMessage;
+
+  auto work = [&](LLVMTargetMachineRef T) {
+    size_t g;
+    while (!failed && (g = nextGroup++) < groups.size()) {
+      for (auto i : groups[g]) {
+        char *errMsg = nullptr;
+        if (LLVMTargetMachineEmitToMemoryBuffer(T, mods[i], codegen, &errMsg,
+                                                &bufs[i])) {
+          std::lock_guard<std::mutex> lock(errorMutex);
+          if (i < errorIndex) {
+            errorIndex = i;
+            errorMessage = errMsg ? errMsg : "";
+          }
+          if (errMsg)
+            LLVMDisposeMessage(errMsg);
+          bufs[i] = nullptr;
+          failed = true;
+          break;
+        }
+      }
+    }
+  };
+
+  // code generation runs IR passes which may delete blocks and instructions
+  for (auto &group : groups)
+    PymIREpoch::bump(LLVMGetModuleContext(mods[group.front()]));
+
+  // the workers run on behalf of this thread
+  std::vector<PymContextUse> uses;
+  uses.reserve(groups.size());
+  for (auto &group : groups)
+    uses.emplace_back(LLVMGetModuleContext(mods[group.front()]));
+
+  {
+    nb::gil_scoped_release release;
+    if (workers == 1) {
+      work(tm.get());
+    } else {
+      std::vector<std::thread> threads;
+      threads.reserve(workers);
+      for (size_t w = 0; w < workers; w++) {
+        threads.emplace_back([&]() {
+          auto T = cloneTargetMachine(tm.get());
+          if (!T) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            // an error of a module takes precedence
+            if (errorIndex == num)
+              errorMessage = "Failed to create a target machine for a worker thread.";
+            failed = true;
+            return;
+          }
+          work(T);
+          LLVMDisposeTargetMachine(T);
+        });
+      }
+      for (auto &t : threads)
+        t.join();
+    }
+  }
+
+  if (failed) {
+    for (auto buf : bufs)
+      if (buf)
+        LLVMDisposeMemoryBuffer(buf);
+    throw std::runtime_error(errorMessage);
+  }
+
+  std::vector<PymMemoryBuffer> res;
+  res.reserve(num);
+  for (auto buf : bufs)
+    res.emplace_back(buf);
+  return res;
+}
+
 void populateTargetMachine(nanobind::module_ &m) {
   BIND_ITERATOR_CLASS(PymTargetIterator, "TargetIterator")
 
@@ -27,6 +167,16 @@ void populateTargetMachine(nanobind::module_ &m) {
   auto TargetClass =
     nb::class_<PymTarget, PymLLVMObject<PymTarget, LLVMTargetRef>>(m, "Target", "Target");
 
+  auto CompilationCacheClass =
+    nb::class_<PymCompilationCache>
+      (m, "CompilationCache",
+       "An on-disk cache of emitted code, keyed by a hash of the module bitcode and "
+       "the target triple, CPU, features, optimization level and other code "
+       "generation settings of the target machine. The cache directory can be "
+       "shared by several processes.\n\n"
+       "Entries are evicted least recently used first once their total size "
+       "exceeds max_size bytes.");
+
 
   m.def("get_default_target_triple",
         [](){
@@ -76,6 +226,10 @@ void populateTargetMachine(nanobind::module_ &m) {
       .value("Medium", LLVMCodeModel::LLVMCodeModelMedium)
       .value("Large", LLVMCodeModel::LLVMCodeModelLarge);
 
+  nb::enum_<LLVMCodeGenFileType>(m, "CodeGenFileType", "CodeGenFileType")
+      .value("AssemblyFile", LLVMCodeGenFileType::LLVMAssemblyFile)
+      .value("ObjectFile", LLVMCodeGenFileType::LLVMObjectFile);
+
   TargetClass
       .def("__iter__", [](PymTarget &self) { return PymTargetIterator(self); })
       .def_static("get_first",
@@ -234,9 +388,15 @@ void populateTargetMachine(nanobind::module_ &m) {
       .def("emit_to_file",
            [](PymTargetMachine &self, PymModule &m, const char *filename,
               LLVMCodeGenFileType codegen) {
-             char *errorMessage;
-             auto res = LLVMTargetMachineEmitToFile
-                          (self.get(), m.get(), filename, codegen, &errorMessage);
+             char *errorMessage = nullptr;
+             bool res;
+             PymIREpoch::bump(LLVMGetModuleContext(m.get()));
+             {
+               PymContextUse use(LLVMGetModuleContext(m.get()));
+               nb::gil_scoped_release release;
+               res = LLVMTargetMachineEmitToFile
+                       (self.get(), m.get(), filename, codegen, &errorMessage) == 0;
+             }
              THROW_ERORR_DISPOSE_MESSAGE_IF_FALSE(res, errorMessage);
            },
            "module"_a, "filename"_a, "codegen"_a,
@@ -247,16 +407,113 @@ void populateTargetMachine(nanobind::module_ &m) {
       .def("emit_to_memory_buffer",
            [](PymTargetMachine &self, PymModule &m, LLVMCodeGenFileType codegen) {
              LLVMMemoryBufferRef outMemBuf;
-             char *errorMessage;
-             auto res = LLVMTargetMachineEmitToMemoryBuffer
-                          (self.get(), m.get(), codegen, &errorMessage, &outMemBuf);
+             char *errorMessage = nullptr;
+             bool res;
+             PymIREpoch::bump(LLVMGetModuleContext(m.get()));
+             {
+               PymContextUse use(LLVMGetModuleContext(m.get()));
+               nb::gil_scoped_release release;
+               res = LLVMTargetMachineEmitToMemoryBuffer
+                       (self.get(), m.get(), codegen, &errorMessage, &outMemBuf) == 0;
+             }
              THROW_ERORR_DISPOSE_MESSAGE_IF_FALSE(res, errorMessage);
+             return PymMemoryBuffer(outMemBuf);
            },
-           "module"_a, "codegen"_a)
+           "module"_a, "codegen"_a,
+           "Emits an asm or object file for the given module into a memory buffer.\n"
+           "The returned MemoryBuffer supports the buffer protocol, so the code can "
+           "be accessed without copying, e.g. ``memoryview(buf)``.\n\n"
+           "Raises:\n"
+           "\tRuntimeError")
+      .def("emit_many", &emitMany,
+           "modules"_a, "codegen"_a, "max_workers"_a = nb::none(),
+           "Emits an asm or object file for each of the given modules into a memory "
+           "buffer, using up to max_workers native threads (defaults to the number "
+           "of hardware threads). Buffers are returned in the order of modules.\n\n"
+           "Each worker uses its own copy of this target machine. Modules sharing a "
+           "context are emitted sequentially.\n\n"
+           "Raises:\n"
+           "\tRuntimeError")
        .def("add_analysis_passes",
             [](PymTargetMachine &self, PymPassManagerBase &pm) {
               return LLVMAddAnalysisPasses(self.get(), pm.get());
             },
             "pm"_a,
             "Adds the target-specific analysis passes to the pass manager.");
+
+  CompilationCacheClass
+      .def(nb::init<std::string, uint64_t>(),
+           "directory"_a, "max_size"_a = uint64_t(1) << 30,
+           "Open (creating it if needed) the cache in directory. A max_size of 0 "
+           "means the cache is unbounded.\n\n"
+           "Raises:\n"
+           "\tRuntimeError")
+      .def_prop_ro("directory", &PymCompilationCache::getDirectory)
+      .def_prop_ro("max_size", &PymCompilationCache::getMaxSize)
+      .def_prop_ro("hits", &PymCompilationCache::getHits,
+                   "Number of emissions served from the cache by this object.")
+      .def_prop_ro("misses", &PymCompilationCache::getMisses,
+                   "Number of emissions which needed code generation.")
+      .def_prop_ro("size",
+                   [](PymCompilationCache &self) {
+                     nb::gil_scoped_release release;
+                     return self.size();
+                   },
+                   "Total size of the cached entries in bytes.")
+      .def("key",
+           [](PymCompilationCache &self, PymTargetMachine &tm, PymModule &m,
+              LLVMCodeGenFileType codegen) {
+             PymContextUse use(LLVMGetModuleContext(m.get()));
+             nb::gil_scoped_release release;
+             return self.key(tm.get(), m.get(), codegen);
+           },
+           "target_machine"_a, "module"_a, "codegen"_a,
+           "The hex digest identifying the code emitted for module by "
+           "target_machine.")
+      .def("emit_to_memory_buffer",
+           [](PymCompilationCache &self, PymTargetMachine &tm, PymModule &m,
+              LLVMCodeGenFileType codegen) {
+             std::unique_ptr<llvm::MemoryBuffer> buf;
+             // code generation on a cache miss may modify the module
+             PymIREpoch::bump(LLVMGetModuleContext(m.get()));
+             {
+               PymContextUse use(LLVMGetModuleContext(m.get()));
+               nb::gil_scoped_release release;
+               buf = self.emit(tm.get(), m.get(), codegen);
+             }
+             // a cached entry is read without a null terminator
+             return PymMemoryBuffer(llvm::wrap(buf.release()), false);
+           },
+           "target_machine"_a, "module"_a, "codegen"_a,
+           "Same as TargetMachine.emit_to_memory_buffer, but returns the cached "
+           "code if there is any. Note a cache hit skips code generation, which "
+           "otherwise may modify the module.\n\n"
+           "Raises:\n"
+           "\tRuntimeError")
+      .def("emit_to_file",
+           [](PymCompilationCache &self, PymTargetMachine &tm, PymModule &m,
+              const char *filename, LLVMCodeGenFileType codegen) {
+             PymIREpoch::bump(LLVMGetModuleContext(m.get()));
+             PymContextUse use(LLVMGetModuleContext(m.get()));
+             nb::gil_scoped_release release;
+             self.emitToFile(tm.get(), m.get(), filename, codegen);
+           },
+           "target_machine"_a, "module"_a, "filename"_a, "codegen"_a,
+           "Same as TargetMachine.emit_to_file, but copies the cached code if "
+           "there is any.\n\n"
+           "Raises:\n"
+           "\tRuntimeError")
+      .def("prune",
+           [](PymCompilationCache &self) {
+             nb::gil_scoped_release release;
+             self.prune();
+           },
+           "Evict entries until the cache fits into max_size. This also happens "
+           "automatically whenever an entry is added.")
+      .def("clear",
+           [](PymCompilationCache &self) {
+             nb::gil_scoped_release release;
+             self.clear();
+           },
+           "Remove all the entries.");
 }
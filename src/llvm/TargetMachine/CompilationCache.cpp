@@ -0,0 +1,183 @@
+#include "CompilationCache.h"
+
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/CachePruning.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Process.h>
+#include <llvm/Support/SHA256.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Target/TargetMachine.h>
+#include <chrono>
+#include <stdexcept>
+
+using namespace llvm;
+
+static constexpr const char *entryPrefix = "llvmcache-";
+
+PymCompilationCache::PymCompilationCache(std::string directory, uint64_t maxSize)
+: directory(std::move(directory)), maxSize(maxSize) {
+  if (auto EC = sys::fs::create_directories(this->directory))
+    throw std::runtime_error("cannot create cache directory " + this->directory +
+                             ": " + EC.message());
+}
+
+std::string PymCompilationCache::key(LLVMTargetMachineRef T, LLVMModuleRef m,
+                                     LLVMCodeGenFileType codegen) const {
+  auto *TM = reinterpret_cast<TargetMachine *>(T);
+  SHA256 hasher;
+  // length-prefix every field, so that different field lists never produce the
+  // same byte stream
+  auto addField = [&](StringRef field) {
+    uint64_t len = field.size();
+    hasher.update(StringRef(reinterpret_cast<const char *>(&len), sizeof(len)));
+    hasher.update(field);
+  };
+  auto addInt = [&](uint64_t value) {
+    addField(utostr(value));
+  };
+
+  // bitcode records the producer (LLVM version) as well
+  SmallVector<char, 0> bitcode;
+  {
+    raw_svector_ostream os(bitcode);
+    WriteBitcodeToFile(*unwrap(m), os);
+  }
+  addField(StringRef(bitcode.data(), bitcode.size()));
+
+  addField(TM->getTargetTriple().str());
+  addField(TM->getTargetCPU());
+  addField(TM->getTargetFeatureString());
+  addInt(static_cast<uint64_t>(TM->getOptLevel()));
+  addInt(static_cast<uint64_t>(TM->getRelocationModel()));
+  addInt(static_cast<uint64_t>(TM->getCodeModel()));
+  addInt(TM->Options.EnableFastISel);
+  addInt(TM->Options.EnableGlobalISel);
+  addInt(static_cast<uint64_t>(TM->Options.GlobalISelAbort));
+  addInt(TM->Options.EnableMachineOutliner);
+  addInt(TM->Options.MCOptions.AsmVerbose);
+  addInt(static_cast<uint64_t>(codegen));
+
+  return toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+std::string PymCompilationCache::entryPath(const std::string &key) const {
+  SmallString<128> path(directory);
+  sys::path::append(path, entryPrefix + key);
+  return std::string(path);
+}
+
+std::unique_ptr<MemoryBuffer>
+PymCompilationCache::emit(LLVMTargetMachineRef tm, LLVMModuleRef m,
+                          LLVMCodeGenFileType codegen) {
+  // code generation modifies the module, so hash it beforehand
+  auto path = entryPath(key(tm, m, codegen));
+
+  auto cached = MemoryBuffer::getFile(path, /*IsText=*/false,
+                                      /*RequiresNullTerminator=*/false);
+  if (cached) {
+    // refresh the access time, which orders the entries for eviction
+    int FD;
+    if (!sys::fs::openFileForReadWrite(path, FD, sys::fs::CD_OpenExisting,
+                                       sys::fs::OF_None)) {
+      auto now = std::chrono::time_point_cast<std::chrono::nanoseconds>
+                   (std::chrono::system_clock::now());
+      sys::fs::setLastAccessAndModificationTime(FD, now);
+      sys::Process::SafelyCloseFileDescriptor(FD);
+    }
+    hits++;
+    return std::move(*cached);
+  }
+
+  misses++;
+  LLVMMemoryBufferRef out;
+  char *errorMessage = nullptr;
+  if (LLVMTargetMachineEmitToMemoryBuffer(tm, m, codegen, &errorMessage, &out)) {
+    std::string message = errorMessage ? errorMessage : "";
+    if (errorMessage)
+      LLVMDisposeMessage(errorMessage);
+    throw std::runtime_error(message);
+  }
+  std::unique_ptr<MemoryBuffer> buf(unwrap(out));
+  store(path, *buf);
+  prune();
+  return buf;
+}
+
+void PymCompilationCache::emitToFile(LLVMTargetMachineRef tm, LLVMModuleRef m,
+                                     const char *filename,
+                                     LLVMCodeGenFileType codegen) {
+  auto buf = emit(tm, m, codegen);
+  std::error_code EC;
+  raw_fd_ostream os(filename, EC, sys::fs::OF_None);
+  if (EC)
+    throw std::runtime_error(EC.message());
+  os << buf->getBuffer();
+  os.close();
+  if (os.has_error()) {
+    EC = os.error();
+    os.clear_error();
+    throw std::runtime_error(EC.message());
+  }
+}
+
+void PymCompilationCache::store(const std::string &path, const MemoryBuffer &buf) {
+  // write to a temporary file first and rename it, so that concurrent readers
+  // never see a partially written entry
+  SmallString<128> model(directory);
+  sys::path::append(model, "tmp-%%%%%%%%%%%%%%%%");
+  SmallString<128> tmp;
+  int FD;
+  if (sys::fs::createUniqueFile(model, FD, tmp))
+    return;
+  {
+    raw_fd_ostream os(FD, /*shouldClose=*/true);
+    os << buf.getBuffer();
+    os.close();
+    if (os.has_error()) {
+      os.clear_error();
+      sys::fs::remove(tmp);
+      return;
+    }
+  }
+  if (sys::fs::rename(tmp, path))
+    sys::fs::remove(tmp);
+}
+
+void PymCompilationCache::prune() {
+  if (maxSize == 0)
+    return;
+  CachePruningPolicy policy;
+  policy.Interval = std::chrono::seconds(0);
+  policy.Expiration = std::chrono::seconds(0);
+  policy.MaxSizePercentageOfAvailableSpace = 0;
+  policy.MaxSizeBytes = maxSize;
+  pruneCache(directory, policy);
+}
+
+void PymCompilationCache::clear() {
+  std::error_code EC;
+  for (sys::fs::directory_iterator it(directory, EC), end; it != end && !EC;
+       it.increment(EC)) {
+    if (sys::path::filename(it->path()).starts_with(entryPrefix))
+      sys::fs::remove(it->path());
+  }
+}
+
+uint64_t PymCompilationCache::size() const {
+  uint64_t res = 0;
+  std::error_code EC;
+  for (sys::fs::directory_iterator it(directory, EC), end; it != end && !EC;
+       it.increment(EC)) {
+    if (!sys::path::filename(it->path()).starts_with(entryPrefix))
+      continue;
+    sys::fs::file_status status;
+    if (!sys::fs::status(it->path(), status))
+      res += status.getSize();
+  }
+  return res;
+}
@@ -0,0 +1,87 @@
+#ifndef LLVMPYM_TARGETMACHINE_COMPILATIONCACHE_H
+#define LLVMPYM_TARGETMACHINE_COMPILATIONCACHE_H
+
+#include <llvm-c/Core.h>
+#include <llvm-c/TargetMachine.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace llvm {
+class MemoryBuffer;
+}
+
+/*
+ * An on-disk cache of the code emitted by a target machine.
+ *
+ * Entries are addressed by a hash of the module bitcode together with the
+ * target machine settings affecting code generation (see `key`), so that equal
+ * inputs share an entry across processes. Every entry is a file named
+ * `llvmcache-<key>` in `directory`; the total size of the entries is bounded by
+ * `maxSize` bytes, evicting the least recently used ones first.
+ *
+ * Storing an entry is best-effort: failing to write the cache never fails the
+ * compilation itself.
+ */
+class PymCompilationCache {
+public:
+  /*
+   * `maxSize` of 0 means unbounded. Raises std::runtime_error if `directory`
+   * cannot be created.
+   */
+  PymCompilationCache(std::string directory, uint64_t maxSize);
+
+  std::string key(LLVMTargetMachineRef tm, LLVMModuleRef m,
+                  LLVMCodeGenFileType codegen) const;
+
+  /*
+   * Return the cached code, or emit it and add it to the cache. Raises
+   * std::runtime_error if the code generation fails.
+   */
+  std::unique_ptr<llvm::MemoryBuffer>
+  emit(LLVMTargetMachineRef tm, LLVMModuleRef m, LLVMCodeGenFileType codegen);
+
+  void emitToFile(LLVMTargetMachineRef tm, LLVMModuleRef m, const char *filename,
+                  LLVMCodeGenFileType codegen);
+
+  /*
+   * Evict entries until the cache fits into `maxSize` bytes
+   */
+  void prune();
+
+  void clear();
+
+  /*
+   * Total size of the entries in bytes
+   */
+  uint64_t size() const;
+
+  const std::string &getDirectory() const {
+    return directory;
+  }
+
+  uint64_t getMaxSize() const {
+    return maxSize;
+  }
+
+  uint64_t getHits() const {
+    return hits;
+  }
+
+  uint64_t getMisses() const {
+    return misses;
+  }
+
+private:
+  std::string entryPath(const std::string &key) const;
+  void store(const std::string &path, const llvm::MemoryBuffer &buf);
+
+  std::string directory;
+  uint64_t maxSize;
+  std::atomic<uint64_t> hits{0};
+  std::atomic<uint64_t> misses{0};
+};
+
+
+#endif
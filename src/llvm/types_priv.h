@@ -28,6 +28,12 @@
 #include "types_priv/PymLLVMObject.h"
 #include "types_priv/PymDisasmContext.h"
 #include "types_priv/PymBinary.h"
+#include "types_priv/PymPassBuilderOptions.h"
+#include "types_priv/PymLLJIT.h"
+#include "types_priv/PymThreadSafeContext.h"
+#include "types_priv/PymInternTable.h"
+#include "types_priv/PymIREpoch.h"
+#include "types_priv/PymContextUse.h"
 
 
 #define DEFINE_PY_WRAPPER_CLASS(ClassName, UnderlyingType) \
@@ -59,6 +65,35 @@
     UnderlyingType raw; \
   };
 
+/*
+ * Same as DEFINE_PY_WRAPPER_CLASS_POLYMORPHIC, but objects of the class can be
+ * interned in `internTable()`. An interned object removes its entry on destruction.
+ */
+#define DEFINE_PY_WRAPPER_CLASS_INTERNED(ClassName, UnderlyingType) \
+  class ClassName: public PymLLVMObject<ClassName, UnderlyingType> { \
+  public: \
+    virtual ~ClassName() { \
+      if (internContext) \
+        internTable().release(internContext, raw, this); \
+    } \
+    explicit ClassName(UnderlyingType raw) \
+    : raw(raw) {} \
+    ClassName(const ClassName &other) \
+    : raw(other.raw) {} \
+    \
+    UnderlyingType get() const { \
+      return raw; \
+    } \
+    \
+    static PymInternTable<UnderlyingType, ClassName> &internTable(); \
+    \
+    /* set by PymInternTable::insert */ \
+    LLVMContextRef internContext = nullptr; \
+    \
+  private: \
+    UnderlyingType raw; \
+  };
+
 
 #define DEFINE_DIRECT_SUB_CLASS(ParentClassName, ClassName) \
   class ClassName : public ParentClassName { \
@@ -221,6 +256,66 @@
       macro(PymInstruction, PymAtomicCmpXchgInst) \
       macro(PymInstruction, PymFenceInst)
 
+/*
+ * The most specific wrapper class for a value of a given kind, used to generate
+ * the dispatch table of `PymValueAuto`. Every class must appear in
+ * `PY_FOR_EACH_VALUE_CLASS_RELATIONSHIP`. Values of other kinds are wrapped as
+ * PymValue; `LLVMMetadataAsValueValueKind` and `LLVMInstructionValueKind` are
+ * further dispatched on the metadata kind and opcode.
+ */
+#define PY_FOR_EACH_VALUE_KIND_CLASS(macro) \
+  macro(LLVMArgumentValueKind, PymArgument) \
+  macro(LLVMBasicBlockValueKind, PymBasicBlockValue) \
+  macro(LLVMFunctionValueKind, PymFunction) \
+  macro(LLVMGlobalAliasValueKind, PymGlobalAlias) \
+  macro(LLVMGlobalIFuncValueKind, PymGlobalIFunc) \
+  macro(LLVMGlobalVariableValueKind, PymGlobalVariable) \
+  macro(LLVMConstantExprValueKind, PymConstantExpr) \
+  macro(LLVMConstantArrayValueKind, PymConstantArray) \
+  macro(LLVMConstantStructValueKind, PymConstantStruct) \
+  macro(LLVMConstantVectorValueKind, PymConstantVector) \
+  macro(LLVMUndefValueValueKind, PymUndefValue) \
+  macro(LLVMConstantDataArrayValueKind, PymConstantDataArray) \
+  macro(LLVMConstantDataVectorValueKind, PymConstantDataVector) \
+  macro(LLVMConstantIntValueKind, PymConstantInt) \
+  macro(LLVMConstantFPValueKind, PymConstantFP) \
+  macro(LLVMConstantTokenNoneValueKind, PymConstant) \
+  macro(LLVMConstantAggregateZeroValueKind, PymConstant) \
+  macro(LLVMConstantPointerNullValueKind, PymConstant) \
+  macro(LLVMInlineAsmValueKind, PymInlineAsm) \
+  macro(LLVMPoisonValueValueKind, PymPoisonValue)
+
+/*
+ * The most specific wrapper class for an instruction of a given opcode, used to
+ * generate the dispatch table of `PymInstructionAuto`. Instructions of other
+ * opcodes are wrapped as PymInstruction.
+ * NOTE no opcode corresponds to PymFuncletPadInst
+ */
+#define PY_FOR_EACH_OPCODE_CLASS(macro) \
+  macro(LLVMCall, PymCallInst) \
+  macro(LLVMInvoke, PymInvokeInst) \
+  macro(LLVMFCmp, PymFCmpInst) \
+  macro(LLVMICmp, PymICmpInst) \
+  macro(LLVMGetElementPtr, PymGetElementPtrInst) \
+  macro(LLVMPHI, PymPHINode) \
+  macro(LLVMShuffleVector, PymShuffleVectorInst) \
+  macro(LLVMRet, PymReturnInst) \
+  macro(LLVMSwitch, PymSwitchInst) \
+  macro(LLVMCatchSwitch, PymCatchSwitchInst) \
+  macro(LLVMCleanupRet, PymCleanupReturnInst) \
+  macro(LLVMCatchPad, PymCatchPadInst) \
+  macro(LLVMAlloca, PymAllocaInst) \
+  macro(LLVMInsertValue, PymInsertValueInst) \
+  macro(LLVMExtractValue, PymExtractValueInst) \
+  macro(LLVMBr, PymBranchInst) \
+  macro(LLVMIndirectBr, PymIndirectBrInst) \
+  macro(LLVMLandingPad, PymLandingPadInst) \
+  macro(LLVMLoad, PymLoadInst) \
+  macro(LLVMStore, PymStoreInst) \
+  macro(LLVMAtomicRMW, PymAtomicRMWInst) \
+  macro(LLVMAtomicCmpXchg, PymAtomicCmpXchgInst) \
+  macro(LLVMFence, PymFenceInst)
+
 #define PY_FOR_EACH_TYPE_CLASS_RELASIONSHIP(macro) \
   macro(PymType, PymTypeInt) \
   macro(PymType, PymTypeReal) \
@@ -300,7 +395,14 @@
 \
   BIND_PYLLVMOBJECT_(PymTargetLibraryInfo, LLVMTargetLibraryInfoRef, PymTargetLibraryInfoObject) \
 \
-  BIND_PYLLVMOBJECT_(PymBinary, LLVMBinaryRef, PyBinaryObject)
+  BIND_PYLLVMOBJECT_(PymBinary, LLVMBinaryRef, PyBinaryObject) \
+\
+  BIND_PYLLVMOBJECT_(PymPassBuilderOptions, LLVMPassBuilderOptionsRef, \
+    PymPassBuilderOptionsObject) \
+\
+  BIND_PYLLVMOBJECT_(PymLLJIT, LLVMOrcLLJITRef, PymLLJITObject) \
+  BIND_PYLLVMOBJECT_(PymThreadSafeContext, LLVMOrcThreadSafeContextRef, \
+    PymThreadSafeContextObject)
   
 
 
@@ -308,13 +410,13 @@
 
  
 
-DEFINE_PY_WRAPPER_CLASS_POLYMORPHIC(PymValue, LLVMValueRef)
-DEFINE_PY_WRAPPER_CLASS_POLYMORPHIC(PymType, LLVMTypeRef)
+DEFINE_PY_WRAPPER_CLASS_INTERNED(PymValue, LLVMValueRef)
+DEFINE_PY_WRAPPER_CLASS_INTERNED(PymType, LLVMTypeRef)
 DEFINE_PY_WRAPPER_CLASS(PymDiagnosticInfo, LLVMDiagnosticInfoRef)
 DEFINE_PY_WRAPPER_CLASS_POLYMORPHIC(PymAttribute, LLVMAttributeRef)
 DEFINE_PY_WRAPPER_CLASS(PymNamedMDNode, LLVMNamedMDNodeRef)
 DEFINE_PY_WRAPPER_CLASS(PymUse, LLVMUseRef)
-DEFINE_PY_WRAPPER_CLASS(PymBasicBlock, LLVMBasicBlockRef)
+DEFINE_PY_WRAPPER_CLASS_INTERNED(PymBasicBlock, LLVMBasicBlockRef)
 DEFINE_PY_WRAPPER_CLASS(PymBuilder, LLVMBuilderRef)
 
 DEFINE_PY_WRAPPER_CLASS(PymMetadata, LLVMMetadataRef)
@@ -337,6 +439,8 @@ DEFINE_PY_WRAPPER_CLASS(PymIntrinsic, unsigned)
 DEFINE_DIRECT_SUB_CLASS(PymPassManagerBase, PymPassManager);
 DEFINE_DIRECT_SUB_CLASS(PymPassManagerBase, PymFunctionPassManager);
 
+DEFINE_DIRECT_SUB_CLASS(PymLLJIT, PymLLLazyJIT);
+
 
 #define DEFINE_ITERATOR_CLASS(TypeName, UnderlyingType, GetNextFn) \
   class TypeName { \
@@ -359,6 +463,31 @@ DEFINE_DIRECT_SUB_CLASS(PymPassManagerBase, PymFunctionPassManager);
     UnderlyingType val; \
   };
 
+/*
+ * Same as DEFINE_ITERATOR_CLASS, but yields the interned wrapper returned by
+ * `AutoFn` (see Core/utils.h) for each raw reference
+ */
+#define DEFINE_INTERNED_ITERATOR_CLASS(TypeName, UnderlyingType, RawType, GetNextFn, AutoFn) \
+  class TypeName { \
+  public: \
+    explicit TypeName(RawType val): val(val) {} \
+  \
+  RawType get() { \
+    return val; \
+  } \
+  \
+  UnderlyingType *next() { \
+    if (!val) \
+      throw nanobind::stop_iteration(); \
+    auto prev = val; \
+    val = GetNextFn(val); \
+    return AutoFn(prev); \
+  } \
+  \
+  private: \
+    RawType val; \
+  };
+
 #define BIND_ITERATOR_CLASS(ClassName, PymthonClassName) \
   nanobind::class_<ClassName>(m, PymthonClassName, PymthonClassName) \
   .def("__iter__", [](ClassName &self) { return self; }) \
@@ -369,14 +498,29 @@ DEFINE_DIRECT_SUB_CLASS(PymPassManagerBase, PymFunctionPassManager);
 
 
 DEFINE_ITERATOR_CLASS(PymUseIterator, PymUse, LLVMGetNextUse)
-// DEFINE_ITERATOR_CLASS(PymBasicBlockIterator, PymBasicBlock, LLVMGetNextBasicBlock)
 // DEFINE_ITERATOR_CLASS(PymArgumentIterator, PymArgument, LLVMGetNextParam)
-DEFINE_ITERATOR_CLASS(PymInstructionIterator, PymInstruction, LLVMGetNextInstruction)
+PymInstruction* PymInstructionAuto(LLVMValueRef inst);
+PymBasicBlock* PymBasicBlockAuto(LLVMBasicBlockRef rawBB);
+DEFINE_INTERNED_ITERATOR_CLASS(PymBasicBlockIterator, PymBasicBlock, LLVMBasicBlockRef,
+                               LLVMGetNextBasicBlock, PymBasicBlockAuto)
+DEFINE_INTERNED_ITERATOR_CLASS(PymBasicBlockReverseIterator, PymBasicBlock,
+                               LLVMBasicBlockRef, LLVMGetPreviousBasicBlock,
+                               PymBasicBlockAuto)
+DEFINE_INTERNED_ITERATOR_CLASS(PymInstructionIterator, PymInstruction, LLVMValueRef,
+                               LLVMGetNextInstruction, PymInstructionAuto)
+DEFINE_INTERNED_ITERATOR_CLASS(PymInstructionReverseIterator, PymInstruction,
+                               LLVMValueRef, LLVMGetPreviousInstruction,
+                               PymInstructionAuto)
 DEFINE_ITERATOR_CLASS(PymGlobalVariableIterator, PymGlobalVariable, LLVMGetNextGlobal)
+DEFINE_ITERATOR_CLASS(PymGlobalVariableReverseIterator, PymGlobalVariable,
+                      LLVMGetPreviousGlobal)
 DEFINE_ITERATOR_CLASS(PymGlobalIFuncIterator, PymGlobalIFunc, LLVMGetNextGlobalIFunc)
 DEFINE_ITERATOR_CLASS(PymGlobalAliasIterator, PymGlobalAlias, LLVMGetNextGlobalAlias)
 DEFINE_ITERATOR_CLASS(PymNamedMDNodeIterator, PymNamedMDNode, LLVMGetNextNamedMetadata)
+DEFINE_ITERATOR_CLASS(PymNamedMDNodeReverseIterator, PymNamedMDNode,
+                      LLVMGetPreviousNamedMetadata)
 DEFINE_ITERATOR_CLASS(PymFunctionIterator, PymFunction, LLVMGetNextFunction)
+DEFINE_ITERATOR_CLASS(PymFunctionReverseIterator, PymFunction, LLVMGetPreviousFunction)
 
 
 // Target
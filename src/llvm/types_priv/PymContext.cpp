@@ -1,7 +1,11 @@
 #include "PymContext.h"
+#include "PymInternTable.h"
+#include "PymIREpoch.h"
 
-std::unordered_map<LLVMContextRef, std::weak_ptr<LLVMOpaqueContext>> PymContext::context_map;
-std::mutex PymContext::map_mutex;
+PymOwnershipRegistry<LLVMContextRef, LLVMOpaqueContext> &PymContext::context_registry() {
+  static auto *registry = new PymOwnershipRegistry<LLVMContextRef, LLVMOpaqueContext>();
+  return *registry;
+}
 
 PymContext::PymContext() {
   is_global_context = false;
@@ -46,37 +50,23 @@ LLVMContextRef PymContext::get() const {
 // These problems can possibly be handled by make parent field shared_ptr type,
 // but this makes things far more complex and ugly
 void PymContext::LLVMContextDeleter::operator()(const LLVMContextRef context) const {
-  if (context) {
-    std::lock_guard<std::mutex> lock(PymContext::map_mutex);
-    auto it = PymContext::context_map.find(context);
-    
-    if (it != PymContext::context_map.end()) {
-      LLVMContextDispose(context);
-      
-      PymContext::context_map.erase(context);
-    }
+  // the global context isn't registered, so it is never disposed
+  if (context && PymContext::context_registry().release(context)) {
+    forgetInternedObjects(context);
+    forgetDiagnosticHandler(context);
+    PymIREpoch::forgetContext(context);
+    LLVMContextDispose(context);
   }
 }
 
 
 /*
- * NOTE global context won't stored in context_map
+ * NOTE global context won't stored in context_registry
  */
 std::shared_ptr<LLVMOpaqueContext> PymContext::get_shared_context
 (LLVMContextRef context, bool is_global_context) {
   if (is_global_context)
     return std::shared_ptr<LLVMOpaqueContext>(context, LLVMContextDeleter());
   
-  std::lock_guard<std::mutex> lock(PymContext::map_mutex);
-  auto it = PymContext::context_map.find(context);
-  
-  if (it != PymContext::context_map.end()) {
-    if (auto shared = it->second.lock()) {
-      return shared;
-    }
-  }
-  
-  auto shared = std::shared_ptr<LLVMOpaqueContext>(context, LLVMContextDeleter());
-  PymContext::context_map[context] = shared;
-  return shared;
+  return PymContext::context_registry().acquire(context, LLVMContextDeleter());
 }
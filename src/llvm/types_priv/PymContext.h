@@ -7,6 +7,13 @@
 #include <unordered_map>
 #include <mutex>
 #include "PymLLVMObject.h"
+#include "PymOwnershipRegistry.h"
+
+/*
+ * Drop the diagnostic handler installed through Context.set_diagnostic_handler.
+ * Defined in Core/utils.cpp.
+ */
+void forgetDiagnosticHandler(LLVMContextRef ctx);
 
 class PymContext : public PymLLVMObject<PymContext, LLVMContextRef> {
 public:
@@ -32,8 +39,7 @@ private:
   static std::shared_ptr<LLVMOpaqueContext> get_shared_context(LLVMContextRef context,
    bool is_global_context);
 
-  static std::unordered_map<LLVMContextRef, std::weak_ptr<LLVMOpaqueContext>> context_map;
-  static std::mutex map_mutex;
+  static PymOwnershipRegistry<LLVMContextRef, LLVMOpaqueContext> &context_registry();
 };
 
 
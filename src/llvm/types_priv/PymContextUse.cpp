@@ -0,0 +1,59 @@
+#include "PymContextUse.h"
+#include <cstdlib>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+struct Use {
+  std::thread::id thread;
+  unsigned depth;
+};
+
+std::mutex usesMutex;
+std::unordered_map<LLVMContextRef, Use> uses;
+
+bool checkEnabledFromEnvironment() {
+  const char *env = std::getenv("LLVMPYM_CHECK_CONTEXT_THREADS");
+  return env && *env && *env != '0';
+}
+
+}
+
+std::atomic<bool> PymContextUse::checkEnabled{checkEnabledFromEnvironment()};
+
+void PymContextUse::setCheckEnabled(bool enabled) {
+  checkEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+PymContextUse::PymContextUse(LLVMContextRef ctx) {
+  if (!ctx || !isCheckEnabled())
+    return;
+
+  auto self = std::this_thread::get_id();
+  std::lock_guard<std::mutex> lock(usesMutex);
+  auto [it, inserted] = uses.try_emplace(ctx, Use{self, 0});
+  if (!inserted && it->second.thread != self)
+    throw std::runtime_error("The Context is being used by another thread at the "
+                             "same time. A Context and everything created in it "
+                             "must only be used by one thread at a time.");
+  it->second.depth++;
+  this->ctx = ctx;
+}
+
+PymContextUse::PymContextUse(PymContextUse &&other) noexcept
+: ctx(other.ctx) {
+  other.ctx = nullptr;
+}
+
+PymContextUse::~PymContextUse() {
+  if (!ctx)
+    return;
+
+  std::lock_guard<std::mutex> lock(usesMutex);
+  auto it = uses.find(ctx);
+  if (it != uses.end() && --it->second.depth == 0)
+    uses.erase(it);
+}
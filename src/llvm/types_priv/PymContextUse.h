@@ -0,0 +1,44 @@
+#ifndef LLVMPYM_TYPES_PRIV_PYMCONTEXTUSE_H
+#define LLVMPYM_TYPES_PRIV_PYMCONTEXTUSE_H
+
+#include <llvm-c/Core.h>
+#include <atomic>
+
+/*
+ * Marks that the current thread is working on an LLVMContext for the lifetime
+ * of the object.
+ *
+ * LLVM contexts are not thread-safe. When the thread check (a debug mode, off by
+ * default) is enabled, constructing a PymContextUse while another thread is
+ * using the same context throws std::runtime_error instead of letting the two
+ * threads corrupt the context. When disabled it costs a single atomic load.
+ *
+ * Construct it before releasing the GIL, so that the error is raised with the
+ * GIL held:
+ *
+ *   PymContextUse use(LLVMGetModuleContext(m));
+ *   nb::gil_scoped_release release;
+ */
+class PymContextUse {
+public:
+  explicit PymContextUse(LLVMContextRef ctx);
+  PymContextUse(PymContextUse &&other) noexcept;
+  PymContextUse(const PymContextUse &) = delete;
+  PymContextUse &operator=(const PymContextUse &) = delete;
+  PymContextUse &operator=(PymContextUse &&) = delete;
+  ~PymContextUse();
+
+  static void setCheckEnabled(bool enabled);
+  static bool isCheckEnabled() {
+    return checkEnabled.load(std::memory_order_relaxed);
+  }
+
+private:
+  // null if the check was disabled on construction
+  LLVMContextRef ctx = nullptr;
+
+  static std::atomic<bool> checkEnabled;
+};
+
+
+#endif
@@ -0,0 +1,116 @@
+#include "PymIREpoch.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+constexpr unsigned ShardBits = 4;
+constexpr size_t NumShards = size_t(1) << ShardBits;
+
+using CacheKey = std::pair<const void*, const void*>;
+
+struct CacheKeyHash {
+  size_t operator()(const CacheKey &key) const {
+    auto h = std::hash<const void*>()(key.first);
+    return h ^ (std::hash<const void*>()(key.second) + 0x9E3779B97F4A7C15ull +
+                (h << 6) + (h >> 2));
+  }
+};
+
+struct ContextState {
+  uint64_t epoch;
+  // the epoch `caches` belong to
+  uint64_t cachesEpoch;
+  std::unordered_map<CacheKey, std::shared_ptr<void>, CacheKeyHash> caches;
+};
+
+// keep each shard on its own cache line(s)
+struct alignas(64) Shard {
+  std::mutex mutex;
+  std::unordered_map<LLVMContextRef, ContextState> contexts;
+};
+
+// never destroyed, since wrappers may outlive static destruction
+std::array<Shard, NumShards> &shards() {
+  static auto *shards = new std::array<Shard, NumShards>();
+  return *shards;
+}
+
+Shard &shardOf(LLVMContextRef ctx) {
+  // Fibonacci hashing, see PymOwnershipRegistry
+  auto h = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ctx));
+  h *= 0x9E3779B97F4A7C15ull;
+  return shards()[h >> (64 - ShardBits)];
+}
+
+/*
+ * The state of a context seen for the first time starts at a new generation, so
+ * an epoch recorded for a disposed context never matches a new context at the
+ * same address
+ */
+ContextState &stateOf(Shard &shard, LLVMContextRef ctx) {
+  static std::atomic<uint64_t> generation{0};
+  auto [it, inserted] = shard.contexts.try_emplace(ctx);
+  if (inserted) {
+    auto epoch = (generation.fetch_add(1, std::memory_order_relaxed) + 1) << 40;
+    it->second.epoch = it->second.cachesEpoch = epoch;
+  }
+  return it->second;
+}
+
+}
+
+
+uint64_t PymIREpoch::get(LLVMContextRef ctx) {
+  auto &shard = shardOf(ctx);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  return stateOf(shard, ctx).epoch;
+}
+
+void PymIREpoch::bump(LLVMContextRef ctx) {
+  auto &shard = shardOf(ctx);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  stateOf(shard, ctx).epoch++;
+}
+
+void PymIREpoch::bumpAll() {
+  for (auto &shard : shards()) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    for (auto &[ctx, state] : shard.contexts)
+      state.epoch++;
+  }
+}
+
+std::shared_ptr<void> PymIREpoch::getCache(LLVMContextRef ctx, const void *kind,
+                                           const void *key,
+                                           std::shared_ptr<void> (*make)()) {
+  auto &shard = shardOf(ctx);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto &state = stateOf(shard, ctx);
+  if (state.cachesEpoch != state.epoch) {
+    state.caches.clear();
+    state.cachesEpoch = state.epoch;
+  }
+  auto &cache = state.caches[{kind, key}];
+  if (!cache)
+    cache = make();
+  return cache;
+}
+
+void PymIREpoch::forgetContext(LLVMContextRef ctx) {
+  std::unordered_map<CacheKey, std::shared_ptr<void>, CacheKeyHash> caches;
+  {
+    auto &shard = shardOf(ctx);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.contexts.find(ctx);
+    if (it == shard.contexts.end())
+      return;
+    caches = std::move(it->second.caches);
+    shard.contexts.erase(it);
+  }
+}
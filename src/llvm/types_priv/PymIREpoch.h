@@ -0,0 +1,62 @@
+#ifndef LLVMPYM_TYPES_PRIV_PYMIREPOCH_H
+#define LLVMPYM_TYPES_PRIV_PYMIREPOCH_H
+
+#include <llvm-c/Core.h>
+#include <cstdint>
+#include <memory>
+
+/*
+ * A per-context counter bumped by every binding which adds, removes or moves
+ * functions, global values, named metadata, basic blocks or instructions
+ * (including the Builder methods), or runs code which may do so (passes,
+ * linking, materialization, code generation, JIT compilation). Sequence views
+ * compare it to decide whether their cached elements are still valid, so a
+ * missing bump lets them return dangling references.
+ *
+ * It also keeps per-context caches which live for one epoch, so that they can
+ * be shared by all the objects looking at the same IR (see PymSequenceView).
+ *
+ * The state of each context is kept in one of several independently locked
+ * shards chosen by a hash of the context, so threads working on different
+ * contexts don't contend, and dropped when the context is disposed.
+ */
+class PymIREpoch {
+public:
+  static uint64_t get(LLVMContextRef ctx);
+
+  static void bump(LLVMContextRef ctx);
+
+  /*
+   * Bump the epoch of every context, for code which may modify the IR of any
+   * of them (e.g. JIT compilation)
+   */
+  static void bumpAll();
+
+  /*
+   * The cache of type `Cache` for `key` (e.g. a container) in `ctx`. A new one
+   * is created if there is none, or if the epoch of `ctx` changed since the
+   * caches of `ctx` were last used, in which case all of them are dropped.
+   */
+  template <typename Cache>
+  static std::shared_ptr<Cache> getCache(LLVMContextRef ctx, const void *key) {
+    auto make = []() -> std::shared_ptr<void> { return std::make_shared<Cache>(); };
+    return std::static_pointer_cast<Cache>(getCache(ctx, &cacheKind<Cache>, key, make));
+  }
+
+  /*
+   * Called when the context is disposed
+   */
+  static void forgetContext(LLVMContextRef ctx);
+
+private:
+  // its address tells apart caches of different types for the same key
+  template <typename Cache>
+  static inline const char cacheKind = 0;
+
+  static std::shared_ptr<void> getCache(LLVMContextRef ctx, const void *kind,
+                                        const void *key,
+                                        std::shared_ptr<void> (*make)());
+};
+
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef LLVMPYM_TYPES_PRIV_PYMINTERNTABLE_H
+#define LLVMPYM_TYPES_PRIV_PYMINTERNTABLE_H
+
+#include <llvm-c/Core.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <mutex>
+
+/*
+ * Maps an LLVM reference to the single live wrapper object of it, so that
+ * visiting the same value (type, basic block) again returns the same Python
+ * object instead of allocating a new one.
+ *
+ * Entries are partitioned per context, so that all of them can be dropped when
+ * the context is disposed, and spread over `NumShards` independently locked
+ * shards chosen by a hash of the context, so that threads working on different
+ * contexts don't serialize on one mutex. Each entry also records a `tag` (e.g. value kind and
+ * opcode) describing which wrapper class was chosen for the reference; a lookup
+ * with a different tag misses, so a recycled address never yields a wrapper of
+ * the wrong class.
+ *
+ * The table doesn't own the wrappers: a wrapper removes its own entry on
+ * destruction (see `release`).
+ */
+template <typename Ref, typename Wrapper, size_t NumShards = 16>
+class PymInternTable {
+  static_assert(NumShards >= 2 && (NumShards & (NumShards - 1)) == 0,
+                "NumShards must be a power of two greater than one");
+
+public:
+  Wrapper *find(LLVMContextRef ctx, Ref ref, unsigned tag) {
+    auto &shard = shardOf(ctx);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto ctxIt = shard.contexts.find(ctx);
+    if (ctxIt == shard.contexts.end())
+      return nullptr;
+    auto it = ctxIt->second.find(ref);
+    if (it == ctxIt->second.end() || it->second.tag != tag)
+      return nullptr;
+    return it->second.wrapper;
+  }
+
+  void insert(LLVMContextRef ctx, Ref ref, unsigned tag, Wrapper *wrapper) {
+    auto &shard = shardOf(ctx);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.contexts[ctx][ref] = Entry{wrapper, tag};
+    wrapper->internContext = ctx;
+  }
+
+  /*
+   * Called by the wrapper destructor. Only removes the entry if it still refers
+   * to `wrapper`.
+   */
+  void release(LLVMContextRef ctx, Ref ref, const Wrapper *wrapper) {
+    auto &shard = shardOf(ctx);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto ctxIt = shard.contexts.find(ctx);
+    if (ctxIt == shard.contexts.end())
+      return;
+    auto it = ctxIt->second.find(ref);
+    if (it != ctxIt->second.end() && it->second.wrapper == wrapper)
+      ctxIt->second.erase(it);
+  }
+
+  /*
+   * Called when the underlying LLVM object is erased or deleted
+   */
+  void forget(LLVMContextRef ctx, Ref ref) {
+    auto &shard = shardOf(ctx);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto ctxIt = shard.contexts.find(ctx);
+    if (ctxIt != shard.contexts.end())
+      ctxIt->second.erase(ref);
+  }
+
+  /*
+   * Called when the context is disposed
+   */
+  void forgetContext(LLVMContextRef ctx) {
+    auto &shard = shardOf(ctx);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.contexts.erase(ctx);
+  }
+
+private:
+  struct Entry {
+    Wrapper *wrapper;
+    unsigned tag;
+  };
+
+  // keep each shard on its own cache line(s)
+  struct alignas(64) Shard {
+    std::mutex mutex;
+    std::unordered_map<LLVMContextRef, std::unordered_map<Ref, Entry>> contexts;
+  };
+
+  Shard &shardOf(LLVMContextRef ctx) {
+    // Fibonacci hashing, see PymOwnershipRegistry
+    auto h = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ctx));
+    h *= 0x9E3779B97F4A7C15ull;
+    return shards[h >> (64 - shardBits())];
+  }
+
+  static constexpr unsigned shardBits() {
+    unsigned bits = 0;
+    while ((size_t(1) << bits) < NumShards)
+      bits++;
+    return bits;
+  }
+
+  std::array<Shard, NumShards> shards;
+};
+
+/*
+ * Drop all the interned wrappers of objects inside `ctx`
+ */
+void forgetInternedObjects(LLVMContextRef ctx);
+
+
+#endif
@@ -0,0 +1,19 @@
+#include "PymLLJIT.h"
+#include <llvm-c/Error.h>
+
+PymLLJIT::PymLLJIT(LLVMOrcLLJITRef obj)
+: obj(get_shared_obj(obj)) {}
+
+LLVMOrcLLJITRef PymLLJIT::get() const {
+  return obj.get();
+}
+
+// errors on tear down (e.g. failing to run static destructors of jitted code)
+// cannot be reported anywhere
+static void disposeLLJIT(LLVMOrcLLJITRef jit) {
+  if (auto err = LLVMOrcDisposeLLJIT(jit))
+    LLVMConsumeError(err);
+}
+
+
+SHARED_POINTER_IMPL(PymLLJIT, LLVMOrcLLJITRef, LLVMOrcOpaqueLLJIT, disposeLLJIT)
@@ -0,0 +1,21 @@
+#ifndef LLVMPYM_TYPES_PRIV_PYMLLJIT_H
+#define LLVMPYM_TYPES_PRIV_PYMLLJIT_H
+
+#include <llvm-c/LLJIT.h>
+#include <memory>
+#include <unordered_map>
+#include <mutex>
+#include "PymLLVMObject.h"
+#include "utils.h"
+
+class PymLLJIT : public PymLLVMObject<PymLLJIT, LLVMOrcLLJITRef> {
+public:
+  explicit PymLLJIT(LLVMOrcLLJITRef jit);
+  LLVMOrcLLJITRef get() const;
+  
+private:
+  SHARED_POINTER_DEF(LLVMOrcLLJITRef, LLVMOrcOpaqueLLJIT);
+};
+
+
+#endif
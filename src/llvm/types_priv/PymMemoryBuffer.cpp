@@ -1,11 +1,27 @@
 #include "PymMemoryBuffer.h"
 #include <iostream>
+#include <stdexcept>
 
-std::unordered_map<LLVMMemoryBufferRef,
-                   std::weak_ptr<LLVMOpaqueMemoryBuffer>> PymMemoryBuffer::obj_map;
-std::mutex PymMemoryBuffer::map_mutex;
+PymOwnershipRegistry<LLVMMemoryBufferRef, LLVMOpaqueMemoryBuffer> &
+PymMemoryBuffer::obj_registry() {
+  static auto *registry =
+    new PymOwnershipRegistry<LLVMMemoryBufferRef, LLVMOpaqueMemoryBuffer>();
+  return *registry;
+}
+
+PymMemoryBuffer::PymMemoryBuffer(LLVMMemoryBufferRef obj, bool nullTerminated)
+: isNullTerminated(nullTerminated), obj(get_shared_obj(obj)) { }
 
-PymMemoryBuffer::PymMemoryBuffer(LLVMMemoryBufferRef obj) : obj(get_shared_obj(obj)) { }
+PymMemoryBuffer::PymMemoryBuffer(const PymMemoryBuffer &other)
+: isConsumed(other.isConsumed.load()), isNullTerminated(other.isNullTerminated),
+  obj(other.obj) { }
+
+PymMemoryBuffer &PymMemoryBuffer::operator=(const PymMemoryBuffer &other) {
+  obj = other.obj;
+  isConsumed = other.isConsumed.load();
+  isNullTerminated = other.isNullTerminated;
+  return *this;
+}
 
 LLVMMemoryBufferRef PymMemoryBuffer::get() const {
   return obj.get();
@@ -15,41 +31,37 @@ LLVMMemoryBufferRef PymMemoryBuffer::get() const {
 // it will then call deleter, which is undesired and will lead to crash.
 void PymMemoryBuffer::reset() {
   LLVMMemoryBufferRef m = obj.get();
-  if (m) {
-    std::lock_guard<std::mutex> lock(PymMemoryBuffer::map_mutex);
-    PymMemoryBuffer::obj_map.erase(m);
- }
+  if (m)
+    PymMemoryBuffer::obj_registry().forget(m);
+  isConsumed = true;
+}
+
+bool PymMemoryBuffer::consumed() const {
+  return isConsumed;
+}
+
+bool PymMemoryBuffer::nullTerminated() const {
+  return isNullTerminated;
+}
+
+void PymMemoryBuffer::ensureTransferable() const {
+  if (isConsumed)
+    throw std::runtime_error("The memory buffer has already been consumed.");
+  if (exports > 0)
+    throw std::runtime_error("The memory buffer cannot be consumed while views "
+                             "into its contents (e.g. memoryview) are alive.");
 }
 
 
 void PymMemoryBuffer::Deleter::operator()
 (LLVMMemoryBufferRef mb) const {
-  if (mb) {
-    std::lock_guard<std::mutex> lock(PymMemoryBuffer::map_mutex);
-    auto it = PymMemoryBuffer::obj_map.find(mb);
-    
-    // the logic here is specially designed for `reset` function
-    if (it != PymMemoryBuffer::obj_map.end()) {
-      LLVMDisposeMemoryBuffer(mb);
-      
-      PymMemoryBuffer::obj_map.erase(mb);
-    }
-  }
+  // the logic here is specially designed for `reset` function
+  if (mb && PymMemoryBuffer::obj_registry().release(mb))
+    LLVMDisposeMemoryBuffer(mb);
 }
 
 
 std::shared_ptr<LLVMOpaqueMemoryBuffer> PymMemoryBuffer::get_shared_obj
 (LLVMMemoryBufferRef mb) {
-  std::lock_guard<std::mutex> lock(PymMemoryBuffer::map_mutex);
-  auto it = PymMemoryBuffer::obj_map.find(mb);
-  
-  if (it != PymMemoryBuffer::obj_map.end()) {
-    if (auto shared = it->second.lock()) {
-      return shared;
-    }
-  }
-  
-  auto shared = std::shared_ptr<LLVMOpaqueMemoryBuffer>(mb, Deleter());
-  PymMemoryBuffer::obj_map[mb] = shared;
-  return shared;
+  return PymMemoryBuffer::obj_registry().acquire(mb, Deleter());
 }
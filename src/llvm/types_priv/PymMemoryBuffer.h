@@ -2,6 +2,7 @@
 #define LLVMPYM_TYPES_PRIV_PYMMEMORYBUFFER_H
 
 #include <llvm-c/Core.h>
+#include <atomic>
 #include <memory>
 #include <unordered_map>
 #include <mutex>
@@ -10,7 +11,10 @@
 
 class PymMemoryBuffer : public PymLLVMObject<PymMemoryBuffer, LLVMMemoryBufferRef> {
 public:
-  explicit PymMemoryBuffer(LLVMMemoryBufferRef mb);
+  explicit PymMemoryBuffer(LLVMMemoryBufferRef mb, bool nullTerminated = true);
+  // a copy is a new Python object, which has no views exported yet
+  PymMemoryBuffer(const PymMemoryBuffer &other);
+  PymMemoryBuffer &operator=(const PymMemoryBuffer &other);
   LLVMMemoryBufferRef get() const;
 
   /*
@@ -18,8 +22,36 @@ public:
    * being automatically disposed
    */
   void reset();
+
+  /*
+   * Whether the underlying buffer has been handed over to LLVM (see `reset`)
+   */
+  bool consumed() const;
+
+  /*
+   * Throw if the buffer cannot be handed over to LLVM, i.e. it was already
+   * consumed or Python views into its contents are still alive
+   */
+  void ensureTransferable() const;
+
+  /*
+   * Whether a null byte follows the buffer contents, which the IR lexer relies
+   * on. Only false for buffers borrowing Python memory (see
+   * `createMemoryBufferFromPyBuffer`)
+   */
+  bool nullTerminated() const;
+
+  /*
+   * Number of Python buffer protocol views currently exported from this object.
+   * Memory buffers aren't tied to a context, so views may be taken and released
+   * from several threads at once (on free-threaded Python).
+   */
+  std::atomic<unsigned> exports = 0;
   
 private:
+  std::atomic<bool> isConsumed = false;
+  bool isNullTerminated;
+
   SHARED_POINTER_DEF(LLVMMemoryBufferRef, LLVMOpaqueMemoryBuffer);
 };
 
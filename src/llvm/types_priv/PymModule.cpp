@@ -1,6 +1,12 @@
 #include "PymModule.h"
+#include "PymThreadSafeContext.h"
 #include <stdexcept>
 
+PymOwnershipRegistry<LLVMModuleRef, LLVMOpaqueModule> &PymModule::obj_registry() {
+  static auto *registry = new PymOwnershipRegistry<LLVMModuleRef, LLVMOpaqueModule>();
+  return *registry;
+}
+
 PymModule::PymModule(const std::string &id) {
   obj = get_shared_obj(LLVMModuleCreateWithName(id.c_str()));
   if (!obj) {
@@ -8,7 +14,8 @@ PymModule::PymModule(const std::string &id) {
   }
 }
 
-PymModule::PymModule(const std::string &id, LLVMContextRef context) {
+PymModule::PymModule(const std::string &id, LLVMContextRef context)
+: contextOwner(PymThreadSafeContext::findOwner(context)) {
   obj = get_shared_obj(LLVMModuleCreateWithNameInContext(id.c_str(), context));
   if (!obj) {
     throw std::runtime_error("Failed to create Module");
@@ -16,10 +23,40 @@ PymModule::PymModule(const std::string &id, LLVMContextRef context) {
 }
 
 PymModule::PymModule(LLVMModuleRef obj)
-: obj(get_shared_obj(obj)) { }
+: contextOwner(obj ? PymThreadSafeContext::findOwner(LLVMGetModuleContext(obj))
+                   : nullptr),
+  obj(get_shared_obj(obj)) { }
 
 LLVMModuleRef PymModule::get() const {
   return obj.get();
 }
 
-SHARED_POINTER_IMPL(PymModule, LLVMModuleRef, LLVMOpaqueModule, LLVMDisposeModule)
+// Same as PymMemoryBuffer::reset: only the registry entry is removed, which
+// keeps the Deleter from disposing the module.
+void PymModule::reset() {
+  LLVMModuleRef m = obj.get();
+  if (m)
+    PymModule::obj_registry().forget(m);
+  isConsumed = true;
+}
+
+bool PymModule::consumed() const {
+  return isConsumed;
+}
+
+void PymModule::ensureTransferable() const {
+  if (isConsumed)
+    throw std::runtime_error("The module has already been consumed.");
+}
+
+
+void PymModule::Deleter::operator()(LLVMModuleRef m) const {
+  // the logic here is specially designed for `reset` function
+  if (m && PymModule::obj_registry().release(m))
+    LLVMDisposeModule(m);
+}
+
+
+std::shared_ptr<LLVMOpaqueModule> PymModule::get_shared_obj(LLVMModuleRef m) {
+  return PymModule::obj_registry().acquire(m, Deleter());
+}
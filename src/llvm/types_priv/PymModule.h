@@ -2,6 +2,7 @@
 #define LLVMPYM_TYPES_PRIV_PYMMODULE_H
 
 #include <llvm-c/Core.h>
+#include <llvm-c/Orc.h>
 #include <memory>
 #include <unordered_map>
 #include <mutex>
@@ -17,7 +18,29 @@ public:
 
   LLVMModuleRef get() const;
 
+  /*
+   * This function reset the PymModule object, preventing it from being
+   * automatically disposed. Used after the ownership of the module has been
+   * transferred to LLVM (e.g. linked into another module, added to a JIT)
+   */
+  void reset();
+
+  /*
+   * Whether the ownership of the underlying module has been transferred
+   */
+  bool consumed() const;
+
+  /*
+   * Throw if the module was already consumed
+   */
+  void ensureTransferable() const;
+
 private:
+  bool isConsumed = false;
+  // the ThreadSafeContext owning the context of the module, if any. Declared
+  // before `obj` so that the module is disposed before its context
+  std::shared_ptr<LLVMOrcOpaqueThreadSafeContext> contextOwner;
+
   SHARED_POINTER_DEF(LLVMModuleRef, LLVMOpaqueModule);
 };
 
@@ -0,0 +1,94 @@
+#ifndef LLVMPYM_TYPES_PRIV_PYMOWNERSHIPREGISTRY_H
+#define LLVMPYM_TYPES_PRIV_PYMOWNERSHIPREGISTRY_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+/*
+ * Maps an LLVM pointer to the shared owner of it, so that all the wrapper
+ * objects of the same pointer share one `std::shared_ptr` and the object is
+ * disposed exactly once.
+ *
+ * The entries are spread over `NumShards` independently locked shards chosen
+ * by a hash of the pointer, so that threads creating or destroying unrelated
+ * objects (e.g. modules in different contexts) don't serialize on one mutex.
+ * The deleter never runs while a shard is locked.
+ */
+template <typename Ptr, typename T, size_t NumShards = 64>
+class PymOwnershipRegistry {
+  static_assert(NumShards >= 2 && (NumShards & (NumShards - 1)) == 0,
+                "NumShards must be a power of two greater than one");
+
+public:
+  /*
+   * Return the live owner of `ptr`, or make `ptr` owned by a new shared_ptr
+   * using `deleter`
+   */
+  template <typename Deleter>
+  std::shared_ptr<T> acquire(Ptr ptr, Deleter deleter) {
+    auto &shard = shardOf(ptr);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto &entry = shard.map[ptr];
+    if (auto shared = entry.lock())
+      return shared;
+    std::shared_ptr<T> shared(ptr, std::move(deleter));
+    entry = shared;
+    return shared;
+  }
+
+  /*
+   * Called by the deleter. Removes the entry of `ptr` if it has no live owner
+   * anymore, and returns whether there was such an entry, i.e. whether the
+   * object still needs to be disposed (see `forget`).
+   */
+  bool release(Ptr ptr) {
+    auto &shard = shardOf(ptr);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.map.find(ptr);
+    if (it == shard.map.end() || !it->second.expired())
+      return false;
+    shard.map.erase(it);
+    return true;
+  }
+
+  /*
+   * Remove the entry of `ptr`, so that its deleter won't dispose it. Used
+   * when the ownership of the object is transferred to LLVM.
+   */
+  void forget(Ptr ptr) {
+    auto &shard = shardOf(ptr);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.map.erase(ptr);
+  }
+
+private:
+  // keep each shard on its own cache line(s)
+  struct alignas(64) Shard {
+    std::mutex mutex;
+    std::unordered_map<Ptr, std::weak_ptr<T>> map;
+  };
+
+  Shard &shardOf(Ptr ptr) {
+    // Fibonacci hashing: objects are aligned, so the low bits alone would
+    // pick only a few shards
+    auto h = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr));
+    h *= 0x9E3779B97F4A7C15ull;
+    return shards[h >> (64 - shardBits())];
+  }
+
+  static constexpr unsigned shardBits() {
+    unsigned bits = 0;
+    while ((size_t(1) << bits) < NumShards)
+      bits++;
+    return bits;
+  }
+
+  std::array<Shard, NumShards> shards;
+};
+
+
+#endif
@@ -0,0 +1,12 @@
+#include "PymPassBuilderOptions.h"
+
+PymPassBuilderOptions::PymPassBuilderOptions(LLVMPassBuilderOptionsRef obj)
+: obj(get_shared_obj(obj)) {}
+
+LLVMPassBuilderOptionsRef PymPassBuilderOptions::get() const {
+  return obj.get();
+}
+
+
+SHARED_POINTER_IMPL(PymPassBuilderOptions, LLVMPassBuilderOptionsRef,
+                    LLVMOpaquePassBuilderOptions, LLVMDisposePassBuilderOptions)
@@ -0,0 +1,42 @@
+#ifndef LLVMPYM_TYPES_PRIV_PYMPASSBUILDEROPTIONS_H
+#define LLVMPYM_TYPES_PRIV_PYMPASSBUILDEROPTIONS_H
+
+#include <llvm-c/Transforms/PassBuilder.h>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <mutex>
+#include "PymLLVMObject.h"
+#include "utils.h"
+
+class PymPassBuilderOptions : public PymLLVMObject<PymPassBuilderOptions, LLVMPassBuilderOptionsRef> {
+public:
+  explicit PymPassBuilderOptions(LLVMPassBuilderOptionsRef options);
+  LLVMPassBuilderOptionsRef get() const;
+
+  /*
+   * The C API cannot read options back, so the values set through the bindings
+   * are recorded here as well. Unset tuning options keep LLVM's defaults.
+   */
+  struct Settings {
+    bool debugLogging = false;
+    bool verifyEach = false;
+    std::optional<bool> loopInterleaving;
+    std::optional<bool> loopVectorization;
+    std::optional<bool> slpVectorization;
+    std::optional<bool> loopUnrolling;
+    std::optional<bool> forgetAllSCEVInLoopUnroll;
+    std::optional<unsigned> licmMssaOptCap;
+    std::optional<unsigned> licmMssaNoAccForPromotionCap;
+    std::optional<bool> callGraphProfile;
+    std::optional<bool> mergeFunctions;
+  };
+
+  Settings settings;
+  
+private:
+  SHARED_POINTER_DEF(LLVMPassBuilderOptionsRef, LLVMOpaquePassBuilderOptions);
+};
+
+
+#endif
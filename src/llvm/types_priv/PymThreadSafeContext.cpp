@@ -0,0 +1,44 @@
+#include "PymThreadSafeContext.h"
+
+PymThreadSafeContext::PymThreadSafeContext(LLVMOrcThreadSafeContextRef obj)
+: obj(get_shared_obj(obj)) {
+  if (!obj)
+    return;
+  std::lock_guard<std::mutex> lock(ownersMutex());
+  owners()[LLVMOrcThreadSafeContextGetContext(obj)] = this->obj;
+}
+
+std::shared_ptr<LLVMOrcOpaqueThreadSafeContext>
+PymThreadSafeContext::findOwner(LLVMContextRef ctx) {
+  std::lock_guard<std::mutex> lock(ownersMutex());
+  auto &map = owners();
+  auto it = map.find(ctx);
+  if (it == map.end())
+    return nullptr;
+  auto owner = it->second.lock();
+  // the address may be reused by an unrelated context afterwards
+  if (!owner)
+    map.erase(it);
+  return owner;
+}
+
+std::unordered_map<LLVMContextRef, std::weak_ptr<LLVMOrcOpaqueThreadSafeContext>> &
+PymThreadSafeContext::owners() {
+  static auto *map =
+    new std::unordered_map<LLVMContextRef,
+                           std::weak_ptr<LLVMOrcOpaqueThreadSafeContext>>();
+  return *map;
+}
+
+std::mutex &PymThreadSafeContext::ownersMutex() {
+  static auto *mutex = new std::mutex();
+  return *mutex;
+}
+
+LLVMOrcThreadSafeContextRef PymThreadSafeContext::get() const {
+  return obj.get();
+}
+
+
+SHARED_POINTER_IMPL(PymThreadSafeContext, LLVMOrcThreadSafeContextRef,
+                    LLVMOrcOpaqueThreadSafeContext, LLVMOrcDisposeThreadSafeContext)
@@ -0,0 +1,34 @@
+#ifndef LLVMPYM_TYPES_PRIV_PYMTHREADSAFECONTEXT_H
+#define LLVMPYM_TYPES_PRIV_PYMTHREADSAFECONTEXT_H
+
+#include <llvm-c/Core.h>
+#include <llvm-c/Orc.h>
+#include <memory>
+#include <unordered_map>
+#include <mutex>
+#include "PymLLVMObject.h"
+#include "utils.h"
+
+class PymThreadSafeContext : public PymLLVMObject<PymThreadSafeContext,
+                                                  LLVMOrcThreadSafeContextRef> {
+public:
+  explicit PymThreadSafeContext(LLVMOrcThreadSafeContextRef ctx);
+  LLVMOrcThreadSafeContextRef get() const;
+
+  /*
+   * The live ThreadSafeContext wrapping `ctx`, or null if it isn't wrapped by
+   * one. The LLVMContext is owned by it, so wrappers of objects inside the
+   * context (e.g. modules) hold it to keep the context alive.
+   */
+  static std::shared_ptr<LLVMOrcOpaqueThreadSafeContext> findOwner(LLVMContextRef ctx);
+  
+private:
+  static std::unordered_map<LLVMContextRef,
+                            std::weak_ptr<LLVMOrcOpaqueThreadSafeContext>> &owners();
+  static std::mutex &ownersMutex();
+
+  SHARED_POINTER_DEF(LLVMOrcThreadSafeContextRef, LLVMOrcOpaqueThreadSafeContext);
+};
+
+
+#endif
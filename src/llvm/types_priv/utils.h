@@ -1,6 +1,8 @@
 #ifndef LLVMPYM_TYPES_PRIV_UTILS_H
 #define LLVMPYM_TYPES_PRIV_UTILS_H
 
+#include "PymOwnershipRegistry.h"
+
 #define SHARED_POINTER_DEF(UnderlyingPtrClassName, UnderlyingClassName) \
   std::shared_ptr<UnderlyingClassName> obj; \
 \
@@ -11,42 +13,32 @@
   static std::shared_ptr<UnderlyingClassName> get_shared_obj(UnderlyingPtrClassName \
    obj); \
 \
-  static std::unordered_map<UnderlyingPtrClassName, \
-                            std::weak_ptr<UnderlyingClassName>> obj_map; \
-  static std::mutex map_mutex;
+  static PymOwnershipRegistry<UnderlyingPtrClassName, UnderlyingClassName> &obj_registry();
 
 
 
+/*
+ * The registry is intentionally leaked, so that wrappers destroyed during
+ * interpreter shutdown never touch a destructed registry.
+ */
 #define SHARED_POINTER_IMPL(ClassName, UnderlyingPtrClassName, UnderlyingClassName, DISPOSE_FUNC) \
-  std::unordered_map<UnderlyingPtrClassName, \
-    std::weak_ptr<UnderlyingClassName>> ClassName::obj_map; \
-  std::mutex ClassName::map_mutex; \
+  PymOwnershipRegistry<UnderlyingPtrClassName, UnderlyingClassName> & \
+  ClassName::obj_registry() { \
+    static auto *registry = \
+      new PymOwnershipRegistry<UnderlyingPtrClassName, UnderlyingClassName>(); \
+    return *registry; \
+  } \
   \
   void ClassName::Deleter::operator() \
   (UnderlyingPtrClassName obj) const { \
-    if (obj) { \
+    if (obj && ClassName::obj_registry().release(obj)) \
       DISPOSE_FUNC(obj); \
-  \
-      std::lock_guard<std::mutex> lock(ClassName::map_mutex); \
-      ClassName::obj_map.erase(obj); \
-    } \
   } \
   \
   \
   std::shared_ptr<UnderlyingClassName> ClassName::get_shared_obj \
   (UnderlyingPtrClassName obj) { \
-    std::lock_guard<std::mutex> lock(ClassName::map_mutex); \
-    auto it = ClassName::obj_map.find(obj); \
-  \
-    if (it != ClassName::obj_map.end()) { \
-      if (auto shared = it->second.lock()) { \
-        return shared;  \
-      } \
-    } \
-  \
-    auto shared = std::shared_ptr<UnderlyingClassName>(obj, Deleter()); \
-    ClassName::obj_map[obj] = shared; \
-    return shared; \
+    return ClassName::obj_registry().acquire(obj, Deleter()); \
   }
 
 
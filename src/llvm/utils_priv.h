@@ -50,6 +50,18 @@
     throw std::runtime_error(""); \
   }
 
+/*
+ * Throw a runtime error carrying the message of ERR (a LLVMErrorRef), if any.
+ * Requires llvm-c/Error.h
+ */
+#define THROW_IF_ERROR_REF(ERR) \
+  if (ERR) { \
+    char *_errRefMsg = LLVMGetErrorMessage(ERR); \
+    std::string _errRefStr(_errRefMsg); \
+    LLVMDisposeErrorMessage(_errRefMsg); \
+    throw std::runtime_error(_errRefStr); \
+  }
+
 #define RETURN_MESSAGE(RES) \
   std::string _str(RES); \
   LLVMDisposeMessage(RES); \
@@ -0,0 +1 @@
+from .llvmpym_ext.orc import *
@@ -0,0 +1 @@
+from .llvmpym_ext.pass_builder import *
@@ -11,6 +11,8 @@
 #include "llvm/BitReader.h"
 #include "llvm/Linker.h"
 #include "llvm/Object.h"
+#include "llvm/PassBuilder.h"
+#include "llvm/Orc.h"
 
 namespace nb = nanobind;
 using namespace nb::literals;
@@ -54,4 +56,10 @@ NB_MODULE(llvmpym_ext, m) {
 
   auto objectModule = m.def_submodule("object", "object");
   populateObject(objectModule);
+
+  auto passBuilderModule = m.def_submodule("pass_builder", "pass_builder");
+  populatePassBuilder(passBuilderModule);
+
+  auto orcModule = m.def_submodule("orc", "orc");
+  populateOrc(orcModule);
 }
@@ -1,5 +1,8 @@
 # Note use `pip install .` to install this package
 # In `pip install --no-build-isolation -ve .` mode it won't work
+import mmap
+
+import pytest
 from llvmpym.core import *
 
 class TestContants:
@@ -42,6 +45,484 @@ class TestModule:
         pass
     
 
+class TestMemoryBuffer:
+    def test_buffer_protocol(self):
+        buf = MemoryBuffer.from_str("define void @f() {\n  ret void\n}\n",
+                                    buffer_name="buf")
+        view = memoryview(buf)
+        assert view.readonly
+        assert view.nbytes == buf.buffer_size
+        assert bytes(view).startswith(b"define void @f()")
+
+        with pytest.raises(RuntimeError):
+            Context().parse_ir(buf)
+        view.release()
+
+        ctx = Context()
+        ctx.parse_ir(buf)
+        with pytest.raises(BufferError):
+            memoryview(buf)
+
+
+    def test_from_buffer(self):
+        data = bytearray(b"define void @f() {\n  ret void\n}\n\0")
+        buf = MemoryBuffer.from_buffer(data, requires_null_terminator=True)
+        assert buf.buffer_size == len(data) - 1
+        assert bytes(buf.buffer_start) == bytes(data[:-1])
+
+        # the exported buffer pins the bytearray
+        with pytest.raises(BufferError):
+            data.append(0)
+
+        ctx = Context()
+        m = ctx.parse_ir(buf)
+        assert m.get_named_function("f")
+
+    def test_from_buffer_binary(self):
+        ctx = Context()
+        m = ctx.parse_ir(MemoryBuffer.from_str("define i32 @g() {\n  ret i32 0\n}\n",
+                                               buffer_name="g"))
+        bitcode = bytes(m.write_bitcode_to_memory_buffer())
+        assert bitcode[:2] == b"BC"
+        buf = MemoryBuffer.from_buffer(bitcode)
+        assert bytes(buf.buffer_start) == bitcode
+        assert ctx.parse_bitcode(buf).get_named_function("g")
+
+        with pytest.raises(ValueError):
+            MemoryBuffer.from_buffer(b"abc", requires_null_terminator=True)
+
+
+    def test_from_buffer_not_null_terminated(self, tmp_path):
+        ir = b"define void @f() {\n  ret void\n}\n"
+        # the bytes following the slice are not a null byte
+        data = memoryview(ir + b"define void @g(")[:len(ir)]
+        ctx = Context()
+        m = ctx.parse_ir(MemoryBuffer.from_buffer(data))
+        assert m.get_named_function("f") and not m.get_named_function("g")
+
+        path = tmp_path / "f.ll"
+        path.write_bytes(ir)
+        with open(path, "rb") as f, \
+             mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as mapped:
+            m = ctx.parse_ir(MemoryBuffer.from_buffer(mapped))
+            assert m.get_named_function("f")
+
+    def test_from_file(self, tmp_path):
+        path = tmp_path / "f.ll"
+        path.write_text("define void @f() {\n  ret void\n}\n")
+        for use_mmap in (True, False):
+            buf = MemoryBuffer.from_file(str(path), mmap=use_mmap)
+            assert bytes(buf.buffer_start) == path.read_bytes()
+
+        with pytest.raises(RuntimeError):
+            MemoryBuffer.from_file(str(tmp_path / "missing.ll"))
+
+    def test_parse_files(self, tmp_path):
+        ir_path = tmp_path / "f.ll"
+        ir_path.write_text("define void @f() {\n  ret void\n}\n")
+        bc_path = tmp_path / "f.bc"
+
+        ctx = Context()
+        m = ctx.parse_ir_file(str(ir_path))
+        assert m.get_named_function("f")
+        m.write_bitcode_to_file(str(bc_path))
+
+        assert ctx.parse_ir_file(str(bc_path)).get_named_function("f")
+        assert ctx.parse_bitcode_file(str(bc_path)).get_named_function("f")
+        with pytest.raises(RuntimeError):
+            ctx.parse_bitcode_file(str(ir_path))
+
+
+class TestMaterialize:
+    def test_lazy_bitcode(self, tmp_path):
+        ctx = Context()
+        m = ctx.parse_ir(MemoryBuffer.from_str(
+            "define i32 @f() {\n  ret i32 1\n}\n"
+            "define i32 @g() {\n  ret i32 2\n}\n", buffer_name="m"))
+        path = tmp_path / "m.bc"
+        m.write_bitcode_to_file(str(path))
+
+        lazy = ctx.parse_bitcode_file(str(path), lazy=True)
+        f = lazy.get_named_function("f")
+        g = lazy.get_named_function("g")
+        assert f.is_materializable and g.is_materializable
+        f.materialize()
+        assert not f.is_materializable
+        assert g.is_materializable
+        lazy.materialize_all()
+        assert not g.is_materializable
+
+        eager = ctx.parse_bitcode_file(str(path))
+        assert not eager.get_named_function("f").is_materializable
+
+
+class TestDiagnosticHandler:
+    IR = "define void @f() {\n  ret void\n}\n"
+
+    def _link_with_warning(self, ctx):
+        from llvmpym import linker
+        dest = ctx.parse_ir(MemoryBuffer.from_str(self.IR, buffer_name="dest"))
+        dest.target = "x86_64-unknown-linux-gnu"
+        src = ctx.parse_ir(MemoryBuffer.from_str(self.IR.replace("@f", "@g"),
+                                                 buffer_name="src"))
+        src.target = "aarch64-unknown-linux-gnu"
+        linker.link_module(dest, src)
+
+    def test_per_context(self):
+        ctx, other = Context(), Context()
+        seen = []
+        marker, other_marker = object(), object()
+        ctx.set_diagnostic_handler(lambda info, c: seen.append(c), marker)
+        other.set_diagnostic_handler(lambda info, c: seen.append(c), other_marker)
+        assert ctx.diagnostic_context is marker
+        assert other.get_diagnostic_handler() is not None
+
+        self._link_with_warning(ctx)
+        self._link_with_warning(other)
+        assert seen == [marker, other_marker]
+
+    def test_unset(self):
+        ctx = Context()
+        assert ctx.get_diagnostic_handler() is None
+        assert ctx.diagnostic_context is None
+
+
+class TestInterning:
+    IR = ("define i32 @f(i32 %a) {\n"
+          "entry:\n"
+          "  %b = add i32 %a, 1\n"
+          "  %c = mul i32 %b, %b\n"
+          "  br label %exit\n"
+          "exit:\n"
+          "  ret i32 %c\n"
+          "}\n")
+
+    def test_identity(self):
+        ctx = Context()
+        m = ctx.parse_ir(MemoryBuffer.from_str(self.IR, buffer_name="m"))
+        fn = m.get_named_function("f")
+
+        blocks = fn.basic_blocks
+        assert all(x is y for x, y in zip(blocks, fn.basic_blocks))
+        insts = list(blocks[0].instructions)
+        assert all(x is y for x, y in zip(insts, blocks[0].instructions))
+
+        add, mul = insts[0], insts[1]
+        assert mul.get_operand(0) is add
+        assert mul.operands[1] is add
+
+    def test_erase(self):
+        ctx = Context()
+        m = ctx.parse_ir(MemoryBuffer.from_str(self.IR, buffer_name="m"))
+        block = m.get_named_function("f").basic_blocks[1]
+        ret = next(iter(block.instructions))
+        insts = list(m.get_named_function("f").basic_blocks[0].instructions)
+        br = insts[-1]
+        br.destory()
+        # the wrapper of the erased instruction is not handed out anymore
+        assert all(i is not br for i in
+                   m.get_named_function("f").basic_blocks[0].instructions)
+        assert next(iter(block.instructions)) is ret
+
+
+class TestSequence:
+    IR = ("define void @f() {\n  ret void\n}\n"
+          "define void @g() {\n  ret void\n}\n"
+          "define void @h() {\n  ret void\n}\n")
+
+    def test_indexing(self):
+        ctx = Context()
+        m = ctx.parse_ir(MemoryBuffer.from_str(self.IR, buffer_name="m"))
+        fns = m.functions
+        assert len(fns) == 3
+        assert [f.name for f in fns] == ["f", "g", "h"]
+        assert fns[1].name == "g" and fns[-1].name == "h"
+        assert [f.name for f in reversed(fns)] == ["h", "g", "f"]
+        with pytest.raises(IndexError):
+            fns[3]
+
+    def test_invalidation(self):
+        ctx = Context()
+        m = ctx.parse_ir(MemoryBuffer.from_str(self.IR, buffer_name="m"))
+        fns = m.functions
+        assert len(fns) == 3
+        m.add_function(FunctionType(VoidType(ctx), [], False), "k")
+        assert len(fns) == 4 and fns[-1].name == "k"
+        m.get_named_function("g").destory()
+        assert [f.name for f in fns] == ["f", "h", "k"]
+
+        insts = m.get_named_function("f").basic_blocks[0].instructions
+        assert len(insts) == 1 and insts[0].opcode == Opcode.Ret
+
+    def test_repeated_access(self):
+        ctx = Context()
+        m = ctx.parse_ir(MemoryBuffer.from_str(self.IR, buffer_name="m"))
+        other = ctx.parse_ir(MemoryBuffer.from_str(self.IR.replace("@f", "@x"),
+                                                   buffer_name="other"))
+        # every access creates a new view sharing the elements of the module
+        names = [m.functions[i].name for i in range(len(m.functions))]
+        assert names == ["f", "g", "h"]
+        assert other.functions[0].name == "x" and m.functions[0].name == "f"
+        m.add_function(FunctionType(VoidType(ctx), [], False), "k")
+        assert len(m.functions) == 4 and m.functions[3].name == "k"
+        assert len(other.functions) == 3
+
+    def test_builder_invalidation(self):
+        ctx = Context()
+        ir = "define i32 @f(i32 %a) {\n  %x = add i32 %a, 1\n  ret i32 %x\n}\n"
+        m = ctx.parse_ir(MemoryBuffer.from_str(ir, buffer_name="m"))
+        f = m.get_named_function("f")
+        insts = f.basic_blocks[0].instructions
+        assert len(insts) == 2
+        # insert in the middle, leaving the first and last instruction as is
+        builder = Builder(ctx)
+        builder.position_before(insts[1])
+        builder.mul(f.get_arg(0), f.get_arg(0), "y")
+        assert len(insts) == 3
+        assert [i.opcode for i in insts] == [Opcode.Add, Opcode.Mul, Opcode.Ret]
+        assert insts[1].opcode == Opcode.Mul
+
+
+class TestStructuralHash:
+    @staticmethod
+    def _module(ctx, ir):
+        return ctx.parse_ir(MemoryBuffer.from_str(ir, buffer_name="m"))
+
+    def test_function(self):
+        ctx = Context()
+        f = self._module(ctx, TestInterning.IR).functions[0]
+        renamed = self._module(ctx, TestInterning.IR.replace("@f", "@g")
+                               .replace("%b", "%x")).functions[0]
+        constant = self._module(ctx, TestInterning.IR.replace(
+            "add i32 %a, 1", "add i32 %a, 2")).functions[0]
+        opcode = self._module(ctx, TestInterning.IR.replace("mul", "sub")).functions[0]
+
+        assert f.structural_hash() == renamed.structural_hash()
+        assert f.structural_hash(detailed=True) == \
+            renamed.structural_hash(detailed=True)
+        assert f.structural_hash() == constant.structural_hash()
+        assert f.structural_hash(detailed=True) != \
+            constant.structural_hash(detailed=True)
+        assert f.structural_hash() != opcode.structural_hash()
+
+    def test_module_across_contexts(self):
+        ctx, other_ctx = Context(), Context()
+        m = self._module(ctx, TestInterning.IR)
+        other = self._module(other_ctx, TestInterning.IR.replace("@f", "@g"))
+        assert m.structural_hash() == other.structural_hash()
+        assert m.structural_hash(True) == other.structural_hash(True)
+
+
+class TestExport:
+    def test_export_instructions(self):
+        np = pytest.importorskip("numpy")
+        ctx = Context()
+        m = ctx.parse_ir(MemoryBuffer.from_str(TestInterning.IR, buffer_name="m"))
+        res = m.get_named_function("f").export_instructions()
+
+        assert res["num_instructions"] == 4 and res["num_arguments"] == 1
+        assert list(res["opcode"]) == [Opcode.Add.value, Opcode.Mul.value,
+                                       Opcode.Br.value, Opcode.Ret.value]
+        assert list(res["block"]) == [0, 0, 0, 1]
+        assert list(res["num_operands"]) == [2, 2, 1, 1]
+        assert res["types"][res["type"][0]] == "i32"
+        assert list(res["debug_line"]) == [0, 0, 0, 0]
+
+        offsets, ids = res["operand_offsets"], res["operand_ids"]
+        assert list(offsets) == [0, 2, 4, 5, 6]
+        # %b = add i32 %a, 1
+        assert ids[0] == 4
+        assert res["value_kind"][ids[1]] == ValueKind.ConstantInt.value
+        # %c = mul i32 %b, %b
+        assert list(ids[2:4]) == [0, 0]
+        # ret i32 %c
+        assert ids[5] == 1
+        assert isinstance(res["opcode"], np.ndarray)
+
+    @staticmethod
+    def _row(offsets, targets, i):
+        return list(targets[offsets[i]:offsets[i + 1]])
+
+    def test_def_use_graph(self):
+        pytest.importorskip("numpy")
+        ctx = Context()
+        m = ctx.parse_ir(MemoryBuffer.from_str(TestInterning.IR, buffer_name="m"))
+        g = m.get_named_function("f").def_use_graph()
+        du = (g["def_use_offsets"], g["def_use_targets"])
+        ud = (g["use_def_offsets"], g["use_def_targets"])
+
+        # ids: 0 %b, 1 %c, 2 br, 3 ret, 4 %a
+        assert self._row(*du, 4) == [0]
+        assert self._row(*du, 0) == [1, 1]
+        assert self._row(*du, 1) == [3]
+        assert self._row(*ud, 1) == [0, 0]
+        assert g["value_kind"][4] == ValueKind.Argument.value
+
+    def test_module_def_use_graph(self):
+        pytest.importorskip("numpy")
+        ctx = Context()
+        ir = ("@g = global i32 0\n"
+              "@p = global ptr @g\n"
+              "define i32 @f() {\n"
+              "  %v = load i32, ptr @g\n"
+              "  ret i32 %v\n"
+              "}\n")
+        m = ctx.parse_ir(MemoryBuffer.from_str(ir, buffer_name="m"))
+        g = m.def_use_graph()
+        du = (g["def_use_offsets"], g["def_use_targets"])
+
+        # ids: 0 @f, 1 @g, 2 @p, 3 %v, 4 ret
+        assert g["num_global_values"] == 3
+        assert sorted(self._row(*du, 1)) == [2, 3]
+        assert self._row(*du, 3) == [4]
+        assert list(g["function"][:5]) == [-1, -1, -1, 0, 0]
+
+    def test_def_use_graph_constant_operands(self):
+        pytest.importorskip("numpy")
+        ctx = Context()
+        gep = "getelementptr ([4 x i8], ptr @str, i64 0, i64 1)"
+        ir = ('@str = private constant [4 x i8] c"abc\\00"\n'
+              f"@vt = global {{ ptr, ptr }} {{ ptr @f, ptr {gep} }}\n"
+              "define void @f() {\n"
+              "  ret void\n"
+              "}\n"
+              "define ptr @h() {\n"
+              f"  ret ptr {gep}\n"
+              "}\n")
+        m = ctx.parse_ir(MemoryBuffer.from_str(ir, buffer_name="m"))
+        g = m.def_use_graph()
+        du = (g["def_use_offsets"], g["def_use_targets"])
+        ud = (g["use_def_offsets"], g["use_def_targets"])
+        values = g["value_table"]
+
+        # ids: 0 @f, 1 @h, 2 @str, 3 @vt
+        [init] = self._row(*ud, 3)
+        assert g["value_kind"][init] == ValueKind.ConstantStruct.value
+        assert self._row(*du, 0) == [init]
+        [expr] = self._row(*du, 2)
+        assert g["value_kind"][expr] == ValueKind.ConstantExpr.value
+        assert self._row(*ud, init) == [0, expr]
+        ret = values.id(m.get_named_function("h").entry_basic_block.terminator)
+        assert sorted(self._row(*du, expr)) == sorted([init, ret])
+        assert self._row(*ud, expr)[0] == 2
+
+    LOOP_IR = ("define void @f(i1 %c) {\n"
+               "entry:\n"
+               "  br label %outer\n"
+               "outer:\n"
+               "  br label %inner\n"
+               "inner:\n"
+               "  br i1 %c, label %inner, label %latch\n"
+               "latch:\n"
+               "  br i1 %c, label %outer, label %exit\n"
+               "exit:\n"
+               "  ret void\n"
+               "}\n"
+               "declare void @g()\n")
+
+    def test_cfg(self):
+        pytest.importorskip("numpy")
+        ctx = Context()
+        m = ctx.parse_ir(MemoryBuffer.from_str(self.LOOP_IR, buffer_name="m"))
+        f = m.get_named_function("f")
+
+        cfg = f.cfg()
+        succ = (cfg["successor_offsets"], cfg["successor_targets"])
+        pred = (cfg["predecessor_offsets"], cfg["predecessor_targets"])
+        assert cfg["num_blocks"] == 5
+        assert self._row(*succ, 2) == [2, 3]
+        assert sorted(self._row(*pred, 1)) == [0, 3]
+
+        assert list(f.dominator_tree()) == [-1, 0, 1, 2, 3]
+        assert list(f.post_dominator_tree()) == [1, 2, 3, 4, -1]
+
+        loops = f.loop_info()
+        assert list(loops["header"]) == [1, 2]
+        assert list(loops["depth"]) == [1, 2]
+        assert list(loops["parent"]) == [-1, 0]
+        assert sorted(self._row(loops["block_offsets"], loops["blocks"], 0)) \
+            == [1, 2, 3]
+        assert list(loops["block_loop"]) == [-1, 0, 1, 0, -1]
+
+        with pytest.raises(ValueError):
+            m.get_named_function("g").dominator_tree()
+
+    def test_operand_ids(self):
+        pytest.importorskip("numpy")
+        ctx = Context()
+        m = ctx.parse_ir(MemoryBuffer.from_str(TestInterning.IR, buffer_name="m"))
+        f = m.get_named_function("f")
+        add, mul = list(f.entry_basic_block.instructions)[:2]
+        values = ValueTable(f)
+        assert list(mul.operand_ids(values)) == [0, 0]
+        assert values[0] == add
+        assert values.id(mul) == 1
+        assert list(add.operand_kinds()) == [ValueKind.Argument.value,
+                                             ValueKind.ConstantInt.value]
+
+        table = m.operand_table()
+        # ids: 0 @f, 1 %b, 2 %c, 3 br, 4 ret, 5 %a
+        assert list(table["instruction_ids"]) == [1, 2, 3, 4]
+        assert list(table["function"]) == [0, 0, 0, 0]
+        assert list(table["operand_offsets"]) == [0, 2, 4, 5, 6]
+        assert list(table["operand_ids"][:5]) == [5, 6, 1, 1, 7]
+        assert table["operand_kinds"][4] == ValueKind.BasicBlock.value
+        assert table["value_table"][5] == f.get_arg(0)
+        assert table["value_kind"].dtype == table["operand_kinds"].dtype
+
+        builder = Builder(ctx)
+        builder.position_before(mul)
+        builder.add(add, add, "d")
+        with pytest.raises(RuntimeError):
+            values[0]
+
+    def test_call_graph(self):
+        pytest.importorskip("numpy")
+        ctx = Context()
+        ir = ("declare void @ext()\n"
+              "define internal void @leaf() {\n"
+              "  call void @ext()\n"
+              "  ret void\n"
+              "}\n"
+              "define internal void @rec(i1 %c) {\n"
+              "  call void @leaf()\n"
+              "  br i1 %c, label %a, label %b\n"
+              "a:\n"
+              "  call void @rec(i1 false)\n"
+              "  ret void\n"
+              "b:\n"
+              "  ret void\n"
+              "}\n"
+              "define void @main() {\n"
+              "  call void @rec(i1 true)\n"
+              "  ret void\n"
+              "}\n")
+        m = ctx.parse_ir(MemoryBuffer.from_str(ir, buffer_name="m"))
+        g = m.call_graph()
+        # nodes: 0 ext, 1 leaf, 2 rec, 3 main, 4 external calling, 5 calls external
+        assert g["num_nodes"] == 6
+        assert g["external_calling_node"] == 4
+        assert g["calls_external_node"] == 5
+        callees = (g["callee_offsets"], g["callee_targets"])
+        # a call to a declaration goes through the declaration's own node
+        assert self._row(*callees, 1) == [0]
+        assert self._row(*callees, 0) == [5]
+        assert self._row(*callees, 5) == []
+        assert sorted(self._row(*callees, 2)) == [1, 2]
+        assert 3 in self._row(*callees, 4)
+        assert sorted(self._row(g["caller_offsets"], g["caller_targets"], 2)) \
+            == [2, 3]
+
+        sccs = [self._row(g["scc_offsets"], g["scc_nodes"], i)
+                for i in range(len(g["scc_offsets"]) - 1)]
+        order = {n: i for i, scc in enumerate(sccs) for n in scc}
+        assert sorted(n for scc in sccs for n in scc) == list(range(6))
+        # bottom-up: callees first
+        assert order[0] < order[1] < order[2] < order[3] < order[4]
+        assert g["scc_has_cycle"][order[2]]
+        assert not g["scc_has_cycle"][order[1]]
+
+
 class TestEquality:
     # TODO
     def test_value(self):
@@ -0,0 +1,105 @@
+# Note use `pip install .` to install this package
+import ctypes
+import gc
+
+import pytest
+
+from llvmpym import core, target
+from llvmpym.orc import LLJIT, LLLazyJIT, ThreadSafeContext
+
+IR = """
+declare i64 @callback(i64)
+
+define i64 @add(i64 %a, i64 %b) {
+  %r = add i64 %a, %b
+  ret i64 %r
+}
+
+define i64 @twice_callback(i64 %x) {
+  %r = call i64 @callback(i64 %x)
+  %s = mul i64 %r, 2
+  ret i64 %s
+}
+"""
+
+
+@pytest.fixture(scope="module", autouse=True)
+def native_target():
+    target.init_native_target()
+    target.init_native_asm_printer()
+
+
+def _module(tsc):
+    return tsc.context.parse_ir(core.MemoryBuffer.from_str(IR, buffer_name="jit"))
+
+
+class TestLLJIT:
+    def test_lookup_and_call(self):
+        jit = LLJIT()
+        tsc = ThreadSafeContext()
+        m = _module(tsc)
+        jit.add_module(m, tsc)
+
+        add = ctypes.CFUNCTYPE(ctypes.c_int64, ctypes.c_int64, ctypes.c_int64)(
+            jit.lookup("add"))
+        assert add(2, 40) == 42
+
+        with pytest.raises(RuntimeError):
+            jit.lookup("no_such_symbol")
+
+    def test_module_is_consumed(self):
+        jit = LLJIT()
+        tsc = ThreadSafeContext()
+        m = _module(tsc)
+        jit.add_module(m, tsc)
+        with pytest.raises(RuntimeError):
+            jit.add_module(m, tsc)
+
+    def test_context_mismatch(self):
+        jit = LLJIT()
+        ctx = core.Context()
+        m = ctx.parse_ir(core.MemoryBuffer.from_str(IR, buffer_name="jit"))
+        with pytest.raises(ValueError):
+            jit.add_module(m, ThreadSafeContext())
+
+    def test_absolute_symbols(self):
+        callback_type = ctypes.CFUNCTYPE(ctypes.c_int64, ctypes.c_int64)
+        callback = callback_type(lambda x: x + 1)
+        callback_addr = ctypes.cast(callback, ctypes.c_void_p).value
+
+        jit = LLJIT()
+        jit.define_absolute_symbols({"callback": callback_addr})
+        tsc = ThreadSafeContext()
+        jit.add_module(_module(tsc), tsc)
+
+        twice = callback_type(jit.lookup("twice_callback"))
+        assert twice(20) == 42
+
+
+class TestThreadSafeContext:
+    def test_context_keeps_it_alive(self):
+        ctx = ThreadSafeContext().context
+        m = ctx.parse_ir(core.MemoryBuffer.from_str(IR, buffer_name="jit"))
+        assert m.get_named_function("add")
+
+    def test_module_keeps_it_alive(self):
+        m = _module(ThreadSafeContext())
+        # neither the ThreadSafeContext nor its Context is referenced anymore
+        gc.collect()
+        assert m.get_named_function("add").name == "add"
+        assert "define i64 @add" in str(m)
+
+
+class TestLLLazyJIT:
+    @pytest.mark.parametrize("threads", [0, 2])
+    def test_lazy_compile(self, threads):
+        jit = LLLazyJIT(num_compile_threads=threads)
+        tsc = ThreadSafeContext()
+        m = _module(tsc)
+        jit.add_lazy_module(m, tsc)
+        with pytest.raises(RuntimeError):
+            jit.add_lazy_module(m, tsc)
+
+        add = ctypes.CFUNCTYPE(ctypes.c_int64, ctypes.c_int64, ctypes.c_int64)(
+            jit.lookup("add"))
+        assert add(2, 40) == 42
@@ -0,0 +1,70 @@
+# Note use `pip install .` to install this package
+import pytest
+
+from llvmpym import core
+from llvmpym.pass_builder import PassBuilderOptions, run_passes
+
+IR = """
+define i32 @f(i32 %x) {
+entry:
+  %a = alloca i32
+  store i32 %x, ptr %a
+  %v = load i32, ptr %a
+  %r = add i32 %v, 0
+  ret i32 %r
+}
+"""
+
+
+def _parse(ctx):
+    return ctx.parse_ir(core.MemoryBuffer.from_str(IR, buffer_name="m"))
+
+
+class TestRunPasses:
+    def test_pipeline(self):
+        ctx = core.Context()
+        m = _parse(ctx)
+        run_passes(m, "function(mem2reg,instcombine)")
+        body = str(m.get_named_function("f"))
+        assert "alloca" not in body
+        assert "add" not in body
+
+    def test_options(self):
+        ctx = core.Context()
+        m = _parse(ctx)
+        options = PassBuilderOptions()
+        options.set_verify_each(True)
+        options.set_loop_vectorization(True)
+        options.set_slp_vectorization(True)
+        options.set_loop_unrolling(True)
+        options.set_loop_interleaving(True)
+        options.set_merge_functions(True)
+        options.set_debug_logging(False)
+        run_passes(m, "default<O3>", options=options)
+        assert "alloca" not in str(m)
+
+    def test_invalid_pipeline(self):
+        ctx = core.Context()
+        m = _parse(ctx)
+        with pytest.raises(RuntimeError):
+            run_passes(m, "no-such-pass")
+
+    def test_report(self):
+        ctx = core.Context()
+        m = _parse(ctx)
+        assert run_passes(m, "function(mem2reg)") is None
+
+        m = _parse(ctx)
+        report = run_passes(m, "function(mem2reg,instcombine),globaldce",
+                            report=True)
+        assert [e["pass"] for e in report] == \
+            ["PromotePass", "InstCombinePass", "GlobalDCEPass"]
+        promote, instcombine, globaldce = report
+        assert promote["ir_kind"] == "function"
+        assert promote["ir_name"] == "f"
+        assert promote["changed"]
+        assert globaldce["ir_kind"] == "module"
+        assert not globaldce["changed"]
+        for entry in report:
+            assert entry["wall_time"] >= 0
+            assert entry["user_time"] >= 0
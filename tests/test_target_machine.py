@@ -0,0 +1,71 @@
+# Note use `pip install .` to install this package
+from llvmpym import core, target, target_machine
+
+IR = """
+define i32 @add(i32 %a, i32 %b) {
+  %c = add i32 %a, %b
+  ret i32 %c
+}
+"""
+
+OBJ = target_machine.CodeGenFileType.ObjectFile
+
+
+def _target_machine():
+    target.init_native_target()
+    target.init_native_asm_printer()
+    triple = target_machine.get_default_target_triple()
+    t = target_machine.Target.get_from_triple(triple)
+    return target_machine.TargetMachine(t, triple,
+                                        target_machine.TargetMachineOptions())
+
+
+def _module(ctx, ir=IR):
+    return ctx.parse_ir(core.MemoryBuffer.from_str(ir, buffer_name="m"))
+
+
+class TestCompilationCache:
+    def test_hit(self, tmp_path):
+        tm = _target_machine()
+        ctx = core.Context()
+        cache = target_machine.CompilationCache(str(tmp_path / "cache"))
+
+        expected = bytes(tm.emit_to_memory_buffer(_module(ctx), OBJ))
+        first = bytes(cache.emit_to_memory_buffer(tm, _module(ctx), OBJ))
+        assert (cache.hits, cache.misses) == (0, 1)
+
+        # a new cache object on the same directory, as after a restart
+        cache = target_machine.CompilationCache(str(tmp_path / "cache"))
+        second = bytes(cache.emit_to_memory_buffer(tm, _module(ctx), OBJ))
+        assert (cache.hits, cache.misses) == (1, 0)
+        assert first == second == expected
+        assert cache.size == len(expected)
+
+        path = tmp_path / "out.o"
+        cache.emit_to_file(tm, _module(ctx), str(path), OBJ)
+        assert path.read_bytes() == expected
+        assert cache.hits == 2
+
+    def test_key(self, tmp_path):
+        tm = _target_machine()
+        ctx = core.Context()
+        cache = target_machine.CompilationCache(str(tmp_path))
+        key = cache.key(tm, _module(ctx), OBJ)
+        assert key == cache.key(tm, _module(ctx), OBJ)
+        assert key != cache.key(tm, _module(ctx, IR.replace("add i32", "sub i32")),
+                                OBJ)
+        assert key != cache.key(tm, _module(ctx),
+                                target_machine.CodeGenFileType.AssemblyFile)
+
+    def test_eviction(self, tmp_path):
+        tm = _target_machine()
+        ctx = core.Context()
+        size = len(bytes(tm.emit_to_memory_buffer(_module(ctx), OBJ)))
+        # room for two entries of about the same size
+        cache = target_machine.CompilationCache(str(tmp_path), int(size * 2.5))
+        for i in range(5):
+            cache.emit_to_memory_buffer(tm, _module(ctx, IR.replace("@add", f"@f{i}")),
+                                        OBJ)
+            assert cache.size <= cache.max_size
+        cache.clear()
+        assert cache.size == 0
@@ -0,0 +1,267 @@
+# Note use `pip install .` to install this package
+import os
+import threading
+from concurrent.futures import ThreadPoolExecutor
+
+import pytest
+
+from llvmpym import core, analysis, linker, target, target_machine
+
+IR = """
+define i64 @work(i64 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi i64 [ 0, %entry ], [ %acc.next, %loop ]
+  %sq = mul i64 %i, %i
+  %acc.next = add i64 %acc, %sq
+  %i.next = add i64 %i, 1
+  %cond = icmp ult i64 %i.next, %n
+  br i1 %cond, label %loop, label %exit
+
+exit:
+  ret i64 %acc.next
+}
+"""
+
+# enough functions that code generation dominates the python-side overhead
+BIG_IR = "\n".join(IR.replace("@work", f"@work{i}") for i in range(200))
+
+
+def _target_machine():
+    target.init_native_target()
+    target.init_native_asm_printer()
+    triple = target_machine.get_default_target_triple()
+    t = target_machine.Target.get_from_triple(triple)
+    return target_machine.TargetMachine(t, triple,
+                                        target_machine.TargetMachineOptions())
+
+
+def _compile(path):
+    # every thread works on its own context, module and target machine
+    ctx = core.Context()
+    mem_buf = core.MemoryBuffer.from_str(BIG_IR, buffer_name="work")
+    m = ctx.parse_ir(mem_buf)
+    assert m.verify(analysis.VerifierFailureAction.ReturnStatus) is None
+    tm = _target_machine()
+    tm.emit_to_file(m, str(path), target_machine.CodeGenFileType.ObjectFile)
+    return os.path.getsize(path)
+
+
+class TestGILRelease:
+    def test_parallel_results_match_serial(self, tmp_path):
+        serial = [_compile(tmp_path / f"s{i}.o") for i in range(4)]
+        with ThreadPoolExecutor(max_workers=4) as pool:
+            parallel = list(pool.map(_compile,
+                                     [tmp_path / f"p{i}.o" for i in range(4)]))
+        assert serial == parallel
+        for i in range(4):
+            assert (tmp_path / f"s{i}.o").read_bytes() == \
+                (tmp_path / f"p{i}.o").read_bytes()
+
+
+class TestEmitMany:
+    def test_buffers_in_order(self):
+        tm = _target_machine()
+        # contexts must outlive their modules
+        contexts = [core.Context() for _ in range(6)]
+        modules = []
+        for i, ctx in enumerate(contexts):
+            # make every module a different size so the order is observable
+            ir = "\n".join(IR.replace("@work", f"@work{j}") for j in range(i + 1))
+            modules.append(ctx.parse_ir(core.MemoryBuffer.from_str(ir, buffer_name="m")))
+
+        expected = [
+            bytes(tm.emit_to_memory_buffer(m.clone(),
+                                           target_machine.CodeGenFileType.ObjectFile))
+            for m in modules
+        ]
+        bufs = tm.emit_many(modules, target_machine.CodeGenFileType.ObjectFile,
+                            max_workers=3)
+        assert [bytes(b) for b in bufs] == expected
+
+    def test_shared_context(self):
+        tm = _target_machine()
+        ctx = core.Context()
+        modules = [ctx.parse_ir(core.MemoryBuffer.from_str(IR, buffer_name="m"))
+                   for _ in range(4)]
+        bufs = tm.emit_many(modules, target_machine.CodeGenFileType.ObjectFile)
+        assert len(bufs) == 4
+        assert len({b.buffer_size for b in bufs}) == 1
+
+
+class TestContextThreadCheck:
+    def test_concurrent_use_raises(self):
+        ctx = core.Context()
+        dest = ctx.parse_ir(core.MemoryBuffer.from_str(IR, buffer_name="dest"))
+        dest.target = "x86_64-unknown-linux-gnu"
+        src = ctx.parse_ir(core.MemoryBuffer.from_str(
+            IR.replace("@work", "@other"), buffer_name="src"))
+        src.target = "aarch64-unknown-linux-gnu"
+        errors = []
+
+        def verify():
+            try:
+                dest.verify(analysis.VerifierFailureAction.ReturnStatus)
+            except RuntimeError as e:
+                errors.append(e)
+
+        def handler(info, _):
+            # called while link_module is using ctx (for the warning about the
+            # different target triples), so ctx is in use by this thread
+            t = threading.Thread(target=verify)
+            t.start()
+            t.join()
+
+        ctx.set_diagnostic_handler(handler)
+        core.set_context_thread_check(True)
+        try:
+            linker.link_module(dest, src)
+        finally:
+            core.set_context_thread_check(False)
+        assert len(errors) == 1
+
+        # the context is released afterwards
+        core.set_context_thread_check(True)
+        try:
+            verify()
+        finally:
+            core.set_context_thread_check(False)
+        assert len(errors) == 1
+
+
+class TestParseMany:
+    def test_mixed_inputs(self, tmp_path):
+        irs = [IR.replace("@work", f"@work{i}") for i in range(6)]
+        ll = tmp_path / "m0.ll"
+        ll.write_text(irs[0])
+
+        ctx = core.Context()
+        bc = tmp_path / "m1.bc"
+        ctx.parse_ir(core.MemoryBuffer.from_str(irs[1], buffer_name="m")) \
+           .write_bitcode_to_file(str(bc))
+        bitcode = bc.read_bytes()
+
+        mem_buf = core.MemoryBuffer.from_str(irs[3], buffer_name="m3")
+        inputs = [ll, str(bc), irs[2].encode(), mem_buf, bytearray(bitcode),
+                  irs[5].encode()]
+        modules = core.parse_many(inputs, max_workers=3)
+
+        names = [[f.name for f in m.functions] for m in modules]
+        assert names == [["work0"], ["work1"], ["work2"], ["work3"], ["work1"],
+                         ["work5"]]
+        # every module lives in a context of its own
+        assert len({m.context for m in modules}) == len(modules)
+        for m in modules:
+            assert m.verify(analysis.VerifierFailureAction.ReturnStatus) is None
+        # memory buffers are only borrowed
+        assert mem_buf.buffer_size > 0
+
+    def test_generator_of_memory_buffers(self):
+        ctx = core.Context()
+        bitcodes = [
+            ctx.parse_ir(core.MemoryBuffer.from_str(IR.replace("@work", f"@work{i}"),
+                                                    buffer_name="m"))
+               .write_bitcode_to_memory_buffer()
+            for i in range(4)
+        ]
+        # the only references to the buffers are dropped while iterating
+        modules = core.parse_many((bitcodes.pop(0) for _ in range(4)),
+                                  max_workers=2)
+        assert [[f.name for f in m.functions] for m in modules] == \
+            [[f"work{i}"] for i in range(4)]
+
+    def test_error_of_first_failing_input(self, tmp_path):
+        inputs = [IR.encode(), b"this is not IR", tmp_path / "missing.ll"]
+        with pytest.raises(RuntimeError, match="buffer 1"):
+            core.parse_many(inputs, max_workers=1)
+
+
+class TestModuleSplit:
+    @staticmethod
+    def _defined(m):
+        return {f.name for f in m.functions if not f.is_declaration}
+
+    def test_partitions_in_own_contexts(self):
+        ctx = core.Context()
+        ir = "\n".join(IR.replace("@work", f"@work{i}") for i in range(8))
+        m = ctx.parse_ir(core.MemoryBuffer.from_str(ir, buffer_name="m"))
+        parts = m.split(4, max_workers=2)
+
+        assert len(parts) == 4
+        defined = [self._defined(p) for p in parts]
+        # every definition ends up in exactly one partition
+        assert sum(len(d) for d in defined) == 8
+        assert set().union(*defined) == {f"work{i}" for i in range(8)}
+        assert len({p.context for p in parts} | {m.context}) == 5
+        for p in parts:
+            assert p.verify(analysis.VerifierFailureAction.ReturnStatus) is None
+
+        bufs = _target_machine().emit_many(
+            parts, target_machine.CodeGenFileType.ObjectFile)
+        assert len(bufs) == 4
+
+    def test_shared_context_and_locals(self):
+        ctx = core.Context()
+        ir = """
+define internal i32 @helper(i32 %a) {
+  ret i32 %a
+}
+
+define i32 @f(i32 %a) {
+  %r = call i32 @helper(i32 %a)
+  ret i32 %r
+}
+
+define i32 @g(i32 %a) {
+  %r = call i32 @helper(i32 %a)
+  ret i32 %r
+}
+"""
+        m = ctx.parse_ir(core.MemoryBuffer.from_str(ir, buffer_name="m"))
+        parts = m.split(2, separate_contexts=False)
+        assert all(p.context == m.context for p in parts)
+        # the local helper stays with both of its users
+        assert [self._defined(p) for p in parts if self._defined(p)] == \
+            [{"helper", "f", "g"}]
+
+        with pytest.raises(ValueError):
+            m.split(0)
+
+
+class TestVerifyParallel:
+    # %x doesn't dominate its use, which only the verifier notices
+    BROKEN_IR = """
+define i32 @bad(i1 %c) {
+entry:
+  br i1 %c, label %then, label %exit
+
+then:
+  %x = add i32 1, 2
+  br label %exit
+
+exit:
+  ret i32 %x
+}
+"""
+
+    def test_valid_module(self):
+        ctx = core.Context()
+        m = ctx.parse_ir(core.MemoryBuffer.from_str(BIG_IR, buffer_name="m"))
+        assert m.verify_parallel(max_workers=4) == []
+
+    def test_broken_functions(self):
+        ctx = core.Context()
+        ir = "\n".join([IR.replace("@work", "@work0"),
+                        self.BROKEN_IR,
+                        IR.replace("@work", "@work1"),
+                        self.BROKEN_IR.replace("@bad", "@bad2")])
+        m = ctx.parse_ir(core.MemoryBuffer.from_str(ir, buffer_name="m"))
+        res = m.verify_parallel(max_workers=3)
+
+        assert [f.name for f, _ in res] == ["bad", "bad2"]
+        for f, message in res:
+            assert "does not dominate all uses" in message
+        assert m.verify(analysis.VerifierFailureAction.ReturnStatus) is not None